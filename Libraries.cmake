@@ -94,3 +94,7 @@ target_sources(${PROJECT_NAME} PRIVATE
 )
 target_include_directories(${PROJECT_NAME} PUBLIC "${TEMPLOG_DIR}")
 source_group("Libraries\\templog" "${TEMPLOG_DIR}")
+
+# Threads
+find_package(Threads REQUIRED)
+target_link_libraries(${PROJECT_NAME} PUBLIC Threads::Threads)
@@ -13,6 +13,7 @@ set(RESOURCE_FILES
    "${SHADER_DIR}/GBuffer.frag"
    "${SHADER_DIR}/GBuffer.vert"
    "${SHADER_DIR}/GBufferCommon.glsl"
+   "${SHADER_DIR}/InstanceCommon.glsl"
    "${SHADER_DIR}/LightingCommon.glsl"
    "${SHADER_DIR}/MaterialCommon.glsl"
    "${SHADER_DIR}/MaterialDefines.glsl"
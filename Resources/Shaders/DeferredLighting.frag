@@ -10,12 +10,13 @@ uniform sampler2D uAlbedo;
 uniform sampler2D uSpecular;
 uniform sampler2D uAmbientOcclusion;
 
-#if LIGHT_TYPE == DIRECTIONAL_LIGHT
-uniform DirectionalLight uDirectionalLight;
-#elif LIGHT_TYPE == POINT_LIGHT
-uniform PointLight uPointLight;
-#elif LIGHT_TYPE == SPOT_LIGHT
-uniform SpotLight uSpotLight;
+// Index of the light within the light block
+uniform int uLightIndex;
+
+#if LIGHT_TYPE == POINT_LIGHT
+uniform samplerCubeShadow uShadowMap;
+#else
+uniform sampler2DShadow uShadowMap;
 #endif
 
 layout(location = 0) out vec4 color;
@@ -48,11 +49,11 @@ vec4 calcLighting()
    vec3 lighting = vec3(0.0);
 
 #if LIGHT_TYPE == DIRECTIONAL_LIGHT
-   lighting += calcDirectionalLighting(uDirectionalLight, lightingParams);
+   lighting += calcDirectionalLighting(uDirectionalLights[uLightIndex], uShadowMap, lightingParams);
 #elif LIGHT_TYPE == POINT_LIGHT
-   lighting += calcPointLighting(uPointLight, lightingParams);
+   lighting += calcPointLighting(uPointLights[uLightIndex], uShadowMap, lightingParams);
 #elif LIGHT_TYPE == SPOT_LIGHT
-   lighting += calcSpotLighting(uSpotLight, lightingParams);
+   lighting += calcSpotLighting(uSpotLights[uLightIndex], uShadowMap, lightingParams);
 #endif
 
    return vec4(lighting, 1.0);
@@ -6,21 +6,17 @@
 #include "MaterialCommon.glsl"
 #include "ViewCommon.glsl"
 
-uniform Material uMaterial;
-
-uniform DirectionalLight uDirectionalLights[MAX_DIRECTIONAL_LIGHTS];
-uniform int uNumDirectionalLights;
-
-uniform PointLight uPointLights[MAX_POINT_LIGHTS];
-uniform int uNumPointLights;
-
-uniform SpotLight uSpotLights[MAX_SPOT_LIGHTS];
-uniform int uNumSpotLights;
+uniform sampler2DShadow uDirectionalShadowMaps[MAX_DIRECTIONAL_LIGHTS];
+uniform samplerCubeShadow uPointShadowMaps[MAX_POINT_LIGHTS];
+uniform sampler2DShadow uSpotShadowMaps[MAX_SPOT_LIGHTS];
 
 uniform sampler2D uAmbientOcclusion;
 
 in vec3 vPosition;
 
+// Point lights in x, spot lights in y
+flat in uvec2 vLightMasks;
+
 #if VARYING_NORMAL
 in vec3 vNormal;
 #endif
@@ -38,18 +34,18 @@ layout(location = 0) out vec4 color;
 LightingParams calcLightingParams(MaterialSampleParams materialSampleParams)
 {
    vec2 texCoord = gl_FragCoord.xy * uFramebufferSize.zw;
-   vec4 diffuseColor = calcMaterialDiffuseColor(uMaterial, materialSampleParams);
+   vec4 diffuseColor = calcMaterialDiffuseColor(materialSampleParams);
 
    LightingParams lightingParams;
 
    lightingParams.diffuseColor = diffuseColor.rgb;
-   lightingParams.specularColor = calcMaterialSpecularColor(uMaterial, materialSampleParams).rgb;
-   lightingParams.shininess = calcMaterialShininess(uMaterial, materialSampleParams);
+   lightingParams.specularColor = calcMaterialSpecularColor(materialSampleParams).rgb;
+   lightingParams.shininess = calcMaterialShininess(materialSampleParams);
    lightingParams.ambientOcclusion = texture(uAmbientOcclusion, texCoord).r;
    lightingParams.alpha = diffuseColor.a;
 
    lightingParams.surfacePosition = vPosition;
-   lightingParams.surfaceNormal = calcMaterialSurfaceNormal(uMaterial, materialSampleParams);
+   lightingParams.surfaceNormal = calcMaterialSurfaceNormal(materialSampleParams);
 
    lightingParams.cameraPosition = uCameraPosition;
 
@@ -74,20 +70,27 @@ vec4 calcLighting()
 
    for (int i = 0; i < uNumDirectionalLights; ++i)
    {
-      lighting += calcDirectionalLighting(uDirectionalLights[i], lightingParams);
+      lighting += calcDirectionalLighting(uDirectionalLights[i], uDirectionalShadowMaps[i], lightingParams);
    }
 
+   // The masks skip lights that can't reach the object being drawn
    for (int i = 0; i < uNumPointLights; ++i)
    {
-      lighting += calcPointLighting(uPointLights[i], lightingParams);
+      if ((vLightMasks.x & (1u << i)) != 0u)
+      {
+         lighting += calcPointLighting(uPointLights[i], uPointShadowMaps[i], lightingParams);
+      }
    }
 
    for (int i = 0; i < uNumSpotLights; ++i)
    {
-      lighting += calcSpotLighting(uSpotLights[i], lightingParams);
+      if ((vLightMasks.y & (1u << i)) != 0u)
+      {
+         lighting += calcSpotLighting(uSpotLights[i], uSpotShadowMaps[i], lightingParams);
+      }
    }
 
-   lighting += calcMaterialEmissiveColor(uMaterial, materialSampleParams);
+   lighting += calcMaterialEmissiveColor(materialSampleParams);
 
    return vec4(lighting, lightingParams.alpha);
 }
@@ -1,11 +1,9 @@
 #include "Version.glsl"
 
 #include "ForwardCommon.glsl"
+#include "InstanceCommon.glsl"
 #include "ViewCommon.glsl"
 
-uniform mat4 uLocalToWorld;
-uniform mat4 uLocalToNormal;
-
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 
@@ -19,6 +17,7 @@ layout(location = 4) in vec3 aBitangent;
 #endif
 
 out vec3 vPosition;
+flat out uvec2 vLightMasks;
 
 #if VARYING_NORMAL
 out vec3 vNormal;
@@ -34,11 +33,12 @@ out mat3 vTBN;
 
 void main()
 {
-   vec4 worldPosition = uLocalToWorld * vec4(aPosition, 1.0);
+   vec4 worldPosition = aLocalToWorld * vec4(aPosition, 1.0);
    vPosition = worldPosition.xyz;
+   vLightMasks = aCustomData;
 
 #if VARYING_NORMAL
-   vNormal = (uLocalToNormal * vec4(aNormal, 1.0)).xyz;
+   vNormal = aLocalToNormal * aNormal;
 #endif
 
 #if VARYING_TEX_COORD
@@ -46,9 +46,9 @@ void main()
 #endif
 
 #if VARYING_TBN
-   vec3 t = normalize(vec3(uLocalToWorld * vec4(aTangent, 0.0)));
-   vec3 b = normalize(vec3(uLocalToWorld * vec4(aBitangent, 0.0)));
-   vec3 n = normalize(vec3(uLocalToWorld * vec4(aNormal, 0.0)));
+   vec3 t = normalize(vec3(aLocalToWorld * vec4(aTangent, 0.0)));
+   vec3 b = normalize(vec3(aLocalToWorld * vec4(aBitangent, 0.0)));
+   vec3 n = normalize(vec3(aLocalToWorld * vec4(aNormal, 0.0)));
    vTBN = mat3(t, b, n);
 #endif
 
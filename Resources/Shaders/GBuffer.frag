@@ -3,8 +3,6 @@
 #include "GBufferCommon.glsl"
 #include "MaterialCommon.glsl"
 
-uniform Material uMaterial;
-
 in vec3 vPosition;
 
 #if VARYING_NORMAL
@@ -38,8 +36,8 @@ void main()
 #endif
 
    position = vPosition;
-   normalShininess = vec4(calcMaterialSurfaceNormal(uMaterial, materialSampleParams), calcMaterialShininess(uMaterial, materialSampleParams));
-   albedo = calcMaterialDiffuseColor(uMaterial, materialSampleParams);
-   specular = calcMaterialSpecularColor(uMaterial, materialSampleParams);
-   emissive = calcMaterialEmissiveColor(uMaterial, materialSampleParams);
+   normalShininess = vec4(calcMaterialSurfaceNormal(materialSampleParams), calcMaterialShininess(materialSampleParams));
+   albedo = calcMaterialDiffuseColor(materialSampleParams);
+   specular = calcMaterialSpecularColor(materialSampleParams);
+   emissive = calcMaterialEmissiveColor(materialSampleParams);
 }
@@ -0,0 +1,6 @@
+#include "Version.glsl"
+
+// Per instance attributes, laid out as in InstanceData (see InstanceBuffer.h)
+layout(location = 6) in mat4 aLocalToWorld;
+layout(location = 10) in mat3 aLocalToNormal;
+layout(location = 13) in uvec2 aCustomData;
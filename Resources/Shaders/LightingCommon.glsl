@@ -4,42 +4,49 @@
 #define POINT_LIGHT 1
 #define SPOT_LIGHT 2
 
+// Laid out to match the light block data in SceneRenderer.cpp (std140). Samplers can't be stored in uniform blocks, so
+// shadow maps are bound separately.
 struct DirectionalLight
 {
    vec3 color;
-   vec3 direction;
-
    bool castShadows;
-   mat4 worldToShadow;
+   vec3 direction;
    float shadowBias;
-   sampler2DShadow shadowMap;
+   mat4 worldToShadow;
 };
 
 struct PointLight
 {
    vec3 color;
-   vec3 position;
    float radius;
-
+   vec3 position;
    bool castShadows;
    vec2 nearFar;
    float shadowBias;
-   samplerCubeShadow shadowMap;
 };
 
 struct SpotLight
 {
    vec3 color;
-   vec3 direction;
-   vec3 position;
    float radius;
+   vec3 direction;
    float beamAngle;
+   vec3 position;
    float cutoffAngle;
-
    bool castShadows;
-   mat4 worldToShadow;
    float shadowBias;
-   sampler2DShadow shadowMap;
+   mat4 worldToShadow;
+};
+
+layout(std140) uniform Lights
+{
+   DirectionalLight uDirectionalLights[MAX_DIRECTIONAL_LIGHTS];
+   PointLight uPointLights[MAX_POINT_LIGHTS];
+   SpotLight uSpotLights[MAX_SPOT_LIGHTS];
+
+   int uNumDirectionalLights;
+   int uNumPointLights;
+   int uNumSpotLights;
 };
 
 struct LightingParams
@@ -130,7 +137,7 @@ vec3 calcSpecular(vec3 lightColor, vec3 specularColor, float shininess, vec3 sur
    return lightColor * (specularColor * specularAmount);
 }
 
-vec3 calcDirectionalLighting(DirectionalLight directionalLight, LightingParams lightingParams)
+vec3 calcDirectionalLighting(DirectionalLight directionalLight, sampler2DShadow shadowMap, LightingParams lightingParams)
 {
    vec3 ambient = calcAmbient(directionalLight.color, lightingParams.diffuseColor, lightingParams.ambientOcclusion);
    vec3 diffuse = calcDiffuse(directionalLight.color, lightingParams.diffuseColor, lightingParams.ambientOcclusion, lightingParams.surfaceNormal, -directionalLight.direction);
@@ -139,13 +146,13 @@ vec3 calcDirectionalLighting(DirectionalLight directionalLight, LightingParams l
    float visibility = 1.0;
    if (directionalLight.castShadows)
    {
-      visibility = sampleShadowMap(directionalLight.shadowMap, lightingParams.surfacePosition, directionalLight.worldToShadow, directionalLight.shadowBias);
+      visibility = sampleShadowMap(shadowMap, lightingParams.surfacePosition, directionalLight.worldToShadow, directionalLight.shadowBias);
    }
 
    return ambient + (diffuse + specular) * visibility;
 }
 
-vec3 calcPointLighting(PointLight pointLight, LightingParams lightingParams)
+vec3 calcPointLighting(PointLight pointLight, samplerCubeShadow shadowMap, LightingParams lightingParams)
 {
    vec3 toLight = pointLight.position - lightingParams.surfacePosition;
    vec3 toLightDirection = normalize(toLight);
@@ -159,13 +166,13 @@ vec3 calcPointLighting(PointLight pointLight, LightingParams lightingParams)
    float visibility = 1.0;
    if (pointLight.castShadows)
    {
-      visibility = sampleShadowMap(pointLight.shadowMap, toLight, pointLight.nearFar, pointLight.shadowBias);
+      visibility = sampleShadowMap(shadowMap, toLight, pointLight.nearFar, pointLight.shadowBias);
    }
 
    return (ambient + (diffuse + specular) * visibility) * attenuation;
 }
 
-vec3 calcSpotLighting(SpotLight spotLight, LightingParams lightingParams)
+vec3 calcSpotLighting(SpotLight spotLight, sampler2DShadow shadowMap, LightingParams lightingParams)
 {
    vec3 toLight = spotLight.position - lightingParams.surfacePosition;
    vec3 toLightDirection = normalize(toLight);
@@ -183,7 +190,7 @@ vec3 calcSpotLighting(SpotLight spotLight, LightingParams lightingParams)
    float visibility = 1.0;
    if (spotLight.castShadows)
    {
-      visibility = sampleShadowMap(spotLight.shadowMap, lightingParams.surfacePosition, spotLight.worldToShadow, spotLight.shadowBias);
+      visibility = sampleShadowMap(shadowMap, lightingParams.surfacePosition, spotLight.worldToShadow, spotLight.shadowBias);
    }
 
    return (ambient + (diffuse + specular) * visibility) * attenuation * spotMultiplier;
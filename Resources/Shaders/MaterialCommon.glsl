@@ -2,28 +2,26 @@
 
 #include "MaterialDefines.glsl"
 
-struct Material
+// Every material has its own buffer for this block (see MaterialConstants in Material.h)
+layout(std140) uniform MaterialConstants
 {
-#if WITH_DIFFUSE_TEXTURE
-   sampler2D diffuseTexture;
-#else
    vec3 diffuseColor;
+   float shininess;
+   vec3 specularColor;
+   vec3 emissiveColor;
+} uMaterial;
+
+#if WITH_DIFFUSE_TEXTURE
+uniform sampler2D uDiffuseTexture;
 #endif
 
 #if WITH_SPECULAR_TEXTURE
-   sampler2D specularTexture;
-#else
-   vec3 specularColor;
+uniform sampler2D uSpecularTexture;
 #endif
 
-   float shininess;
-
-   vec3 emissiveColor;
-
 #if WITH_NORMAL_TEXTURE
-   sampler2D normalTexture;
+uniform sampler2D uNormalTexture;
 #endif
-};
 
 struct MaterialSampleParams
 {
@@ -38,40 +36,40 @@ struct MaterialSampleParams
 #endif
 };
 
-vec4 calcMaterialDiffuseColor(Material material, MaterialSampleParams params)
+vec4 calcMaterialDiffuseColor(MaterialSampleParams params)
 {
 #if WITH_DIFFUSE_TEXTURE
-   return texture(material.diffuseTexture, params.texCoord);
+   return texture(uDiffuseTexture, params.texCoord);
 #else
-   return vec4(material.diffuseColor, 1.0);
+   return vec4(uMaterial.diffuseColor, 1.0);
 #endif
 }
 
-vec4 calcMaterialSpecularColor(Material material, MaterialSampleParams params)
+vec4 calcMaterialSpecularColor(MaterialSampleParams params)
 {
 #if WITH_SPECULAR_TEXTURE
-   return texture(material.specularTexture, params.texCoord);
+   return texture(uSpecularTexture, params.texCoord);
 #else
-   return vec4(material.specularColor, 1.0);
+   return vec4(uMaterial.specularColor, 1.0);
 #endif
 }
 
-vec3 calcMaterialEmissiveColor(Material material, MaterialSampleParams params)
+vec3 calcMaterialEmissiveColor(MaterialSampleParams params)
 {
-   return material.emissiveColor;
+   return uMaterial.emissiveColor;
 }
 
-float calcMaterialShininess(Material material, MaterialSampleParams params)
+float calcMaterialShininess(MaterialSampleParams params)
 {
-   return material.shininess;
+   return uMaterial.shininess;
 }
 
-vec3 calcMaterialSurfaceNormal(Material material, MaterialSampleParams params)
+vec3 calcMaterialSurfaceNormal(MaterialSampleParams params)
 {
    vec3 surfaceNormal;
 
 #if WITH_NORMAL_TEXTURE
-   vec3 tangentSpaceNormal = texture(material.normalTexture, params.texCoord).rgb * 2.0 - 1.0;
+   vec3 tangentSpaceNormal = texture(uNormalTexture, params.texCoord).rgb * 2.0 - 1.0;
    surfaceNormal = normalize(params.tbn * tangentSpaceNormal);
 #else
    surfaceNormal = params.normal;
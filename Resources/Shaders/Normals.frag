@@ -3,8 +3,6 @@
 #include "ForwardCommon.glsl"
 #include "MaterialCommon.glsl"
 
-uniform Material uMaterial;
-
 #if VARYING_NORMAL
 in vec3 vNormal;
 #endif
@@ -31,5 +29,5 @@ void main()
    materialSampleParams.normal = vNormal;
 #endif
 
-   normal = calcMaterialSurfaceNormal(uMaterial, materialSampleParams);
+   normal = calcMaterialSurfaceNormal(materialSampleParams);
 }
@@ -4,10 +4,22 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Core/Assert.h"
    "${SRC_DIR}/Core/Delegate.h"
    "${SRC_DIR}/Core/Delegate.cpp"
+   "${SRC_DIR}/Core/FrameAllocator.h"
+   "${SRC_DIR}/Core/FrameAllocator.cpp"
    "${SRC_DIR}/Core/Hash.h"
+   "${SRC_DIR}/Core/InlineBitset.h"
    "${SRC_DIR}/Core/Log.h"
    "${SRC_DIR}/Core/Log.cpp"
    "${SRC_DIR}/Core/Pointers.h"
+   "${SRC_DIR}/Core/PoolAllocator.h"
+   "${SRC_DIR}/Core/PoolAllocator.cpp"
+   "${SRC_DIR}/Core/RadixSort.h"
+   "${SRC_DIR}/Core/RangeAllocator.h"
+   "${SRC_DIR}/Core/RangeAllocator.cpp"
+   "${SRC_DIR}/Core/SizeClassAllocator.h"
+   "${SRC_DIR}/Core/SizeClassAllocator.cpp"
+   "${SRC_DIR}/Core/ThreadPool.h"
+   "${SRC_DIR}/Core/ThreadPool.cpp"
 
    "${SRC_DIR}/Graphics/BufferObject.h"
    "${SRC_DIR}/Graphics/BufferObject.cpp"
@@ -15,11 +27,15 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Graphics/ForEachUniformType.inl"
    "${SRC_DIR}/Graphics/Framebuffer.h"
    "${SRC_DIR}/Graphics/Framebuffer.cpp"
+   "${SRC_DIR}/Graphics/GeometryArena.h"
+   "${SRC_DIR}/Graphics/GeometryArena.cpp"
    "${SRC_DIR}/Graphics/GraphicsContext.h"
    "${SRC_DIR}/Graphics/GraphicsContext.cpp"
    "${SRC_DIR}/Graphics/GraphicsDefines.h"
    "${SRC_DIR}/Graphics/GraphicsResource.h"
    "${SRC_DIR}/Graphics/GraphicsResource.cpp"
+   "${SRC_DIR}/Graphics/InstanceBuffer.h"
+   "${SRC_DIR}/Graphics/InstanceBuffer.cpp"
    "${SRC_DIR}/Graphics/Material.h"
    "${SRC_DIR}/Graphics/Material.cpp"
    "${SRC_DIR}/Graphics/MaterialParameter.h"
@@ -43,11 +59,16 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Graphics/UniformBufferObject.h"
    "${SRC_DIR}/Graphics/UniformBufferObject.cpp"
    "${SRC_DIR}/Graphics/UniformBufferObjectHelpers.h"
+   "${SRC_DIR}/Graphics/UniformHandle.h"
+   "${SRC_DIR}/Graphics/UniformHandle.cpp"
    "${SRC_DIR}/Graphics/UniformTypes.h"
    "${SRC_DIR}/Graphics/Viewport.h"
 
+   "${SRC_DIR}/Math/BoundingVolumeHierarchy.h"
    "${SRC_DIR}/Math/Bounds.h"
    "${SRC_DIR}/Math/Bounds.cpp"
+   "${SRC_DIR}/Math/FrustumCulling.h"
+   "${SRC_DIR}/Math/FrustumCulling.cpp"
    "${SRC_DIR}/Math/MathUtils.h"
    "${SRC_DIR}/Math/Transform.h"
 
@@ -56,6 +77,8 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Platform/InputTypes.h"
    "${SRC_DIR}/Platform/IOUtils.h"
    "${SRC_DIR}/Platform/IOUtils.cpp"
+   "${SRC_DIR}/Platform/MappedFile.h"
+   "${SRC_DIR}/Platform/MappedFile.cpp"
    "${SRC_DIR}/Platform/OSUtils.h"
    "${SRC_DIR}/Platform/OSUtils.cpp"
    "${SRC_DIR}/Platform/Window.h"
@@ -78,6 +101,7 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Scene/Components/Lights/DirectionalLightComponent.h"
    "${SRC_DIR}/Scene/Components/Lights/DirectionalLightComponent.cpp"
    "${SRC_DIR}/Scene/Components/Lights/LightComponent.h"
+   "${SRC_DIR}/Scene/Components/Lights/LightComponent.cpp"
    "${SRC_DIR}/Scene/Components/Lights/PointLightComponent.h"
    "${SRC_DIR}/Scene/Components/Lights/PointLightComponent.cpp"
    "${SRC_DIR}/Scene/Components/Lights/SpotLightComponent.h"
@@ -92,10 +116,14 @@ target_sources(${PROJECT_NAME} PRIVATE
    "${SRC_DIR}/Scene/Rendering/DeferredSceneRenderer.cpp"
    "${SRC_DIR}/Scene/Rendering/ForwardSceneRenderer.h"
    "${SRC_DIR}/Scene/Rendering/ForwardSceneRenderer.cpp"
+   "${SRC_DIR}/Scene/Rendering/OcclusionBuffer.h"
+   "${SRC_DIR}/Scene/Rendering/OcclusionBuffer.cpp"
    "${SRC_DIR}/Scene/Rendering/SceneRenderer.h"
    "${SRC_DIR}/Scene/Rendering/SceneRenderer.cpp"
    "${SRC_DIR}/Scene/Scene.h"
    "${SRC_DIR}/Scene/Scene.cpp"
+   "${SRC_DIR}/Scene/SceneFile.h"
+   "${SRC_DIR}/Scene/SceneFile.cpp"
 )
 
 if(${CMAKE_SYSTEM_NAME} MATCHES "Darwin")
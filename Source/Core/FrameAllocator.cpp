@@ -0,0 +1,77 @@
+#include "Core/FrameAllocator.h"
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+
+namespace
+{
+   std::size_t alignSize(std::size_t size)
+   {
+      return (size + FrameAllocator::kAlignment - 1) & ~(FrameAllocator::kAlignment - 1);
+   }
+
+   UPtr<uint8_t[]> allocateBlock(std::size_t size)
+   {
+      // The default operator new[] alignment is 16 bytes on all supported 64 bit platforms
+      return UPtr<uint8_t[]>(new uint8_t[size]);
+   }
+}
+
+FrameAllocator::FrameAllocator(std::size_t initialCapacity)
+   : memory(allocateBlock(alignSize(initialCapacity)))
+   , capacity(alignSize(initialCapacity))
+{
+}
+
+void* FrameAllocator::allocate(std::size_t size, std::size_t alignment)
+{
+   ASSERT(alignment <= kAlignment && (kAlignment % alignment) == 0);
+
+   // Every allocation is padded to the maximum alignment, which keeps the bump pointer aligned without a CAS loop
+   std::size_t alignedSize = alignSize(std::max<std::size_t>(size, 1));
+   std::size_t allocationOffset = offset.fetch_add(alignedSize, std::memory_order_relaxed);
+   if (allocationOffset + alignedSize <= capacity)
+   {
+      return memory.get() + allocationOffset;
+   }
+
+   return allocateOverflow(alignedSize);
+}
+
+void FrameAllocator::reset()
+{
+   std::size_t usedSize = std::min(offset.load(std::memory_order_relaxed), capacity) + overflowSize;
+   if (!overflowBlocks.empty())
+   {
+      // Grow the main block so that a frame like this one won't overflow again
+      overflowBlocks.clear();
+      overflowSize = 0;
+
+      capacity = alignSize(usedSize + usedSize / 2);
+      memory = allocateBlock(capacity);
+   }
+
+   offset.store(0, std::memory_order_relaxed);
+}
+
+void* FrameAllocator::allocateOverflow(std::size_t size)
+{
+   std::lock_guard<std::mutex> lock(overflowMutex);
+
+   overflowSize += size;
+
+   if (overflowBlocks.empty() || overflowBlocks.back().offset + size > overflowBlocks.back().capacity)
+   {
+      OverflowBlock block;
+      block.capacity = std::max(size, capacity);
+      block.memory = allocateBlock(block.capacity);
+      overflowBlocks.push_back(std::move(block));
+   }
+
+   OverflowBlock& block = overflowBlocks.back();
+   void* allocation = block.memory.get() + block.offset;
+   block.offset += size;
+
+   return allocation;
+}
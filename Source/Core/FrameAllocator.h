@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Core/Pointers.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Linear allocator for data that only lives for a single frame. Allocation is lock free (and safe from multiple threads)
+// as long as the current block has room. Individual allocations are never freed - everything is released at once by
+// reset(), which also merges any overflow blocks so that the next frame fits in a single block.
+class FrameAllocator
+{
+public:
+   static const std::size_t kAlignment = 16;
+   static const std::size_t kDefaultCapacity = 1024 * 1024;
+
+   explicit FrameAllocator(std::size_t initialCapacity = kDefaultCapacity);
+
+   FrameAllocator(const FrameAllocator& other) = delete;
+   FrameAllocator& operator=(const FrameAllocator& other) = delete;
+
+   void* allocate(std::size_t size, std::size_t alignment = kAlignment);
+
+   template<typename T>
+   T* allocate(std::size_t count)
+   {
+      static_assert(alignof(T) <= kAlignment, "Type is over-aligned for the frame allocator");
+      return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+   }
+
+   // Must not be called while any other thread is allocating, or while any allocated memory is still in use
+   void reset();
+
+   std::size_t getCapacity() const
+   {
+      return capacity;
+   }
+
+private:
+   struct OverflowBlock
+   {
+      UPtr<uint8_t[]> memory;
+      std::size_t capacity = 0;
+      std::size_t offset = 0;
+   };
+
+   void* allocateOverflow(std::size_t size);
+
+   UPtr<uint8_t[]> memory;
+   std::size_t capacity = 0;
+   std::atomic<std::size_t> offset = { 0 };
+
+   std::mutex overflowMutex;
+   std::vector<OverflowBlock> overflowBlocks;
+   std::size_t overflowSize = 0;
+};
+
+// Standard library allocator that allocates from a FrameAllocator (or from the heap, if it doesn't have one)
+template<typename T>
+class FrameStlAllocator
+{
+public:
+   using value_type = T;
+
+   using propagate_on_container_copy_assignment = std::true_type;
+   using propagate_on_container_move_assignment = std::true_type;
+   using propagate_on_container_swap = std::true_type;
+
+   FrameStlAllocator() = default;
+
+   explicit FrameStlAllocator(FrameAllocator* inFrameAllocator)
+      : frameAllocator(inFrameAllocator)
+   {
+   }
+
+   template<typename U>
+   FrameStlAllocator(const FrameStlAllocator<U>& other)
+      : frameAllocator(other.getFrameAllocator())
+   {
+   }
+
+   T* allocate(std::size_t count)
+   {
+      if (frameAllocator)
+      {
+         return frameAllocator->allocate<T>(count);
+      }
+
+      return static_cast<T*>(::operator new(count * sizeof(T)));
+   }
+
+   void deallocate(T* pointer, std::size_t count)
+   {
+      if (!frameAllocator)
+      {
+         ::operator delete(pointer);
+      }
+   }
+
+   FrameAllocator* getFrameAllocator() const
+   {
+      return frameAllocator;
+   }
+
+private:
+   FrameAllocator* frameAllocator = nullptr;
+};
+
+template<typename T, typename U>
+bool operator==(const FrameStlAllocator<T>& first, const FrameStlAllocator<U>& second)
+{
+   return first.getFrameAllocator() == second.getFrameAllocator();
+}
+
+template<typename T, typename U>
+bool operator!=(const FrameStlAllocator<T>& first, const FrameStlAllocator<U>& second)
+{
+   return !(first == second);
+}
+
+template<typename T>
+using FrameVector = std::vector<T, FrameStlAllocator<T>>;
+
+template<typename T>
+FrameVector<T> makeFrameVector(FrameAllocator& frameAllocator)
+{
+   return FrameVector<T>(FrameStlAllocator<T>(&frameAllocator));
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Core/Assert.h"
+#include "Core/FrameAllocator.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed size bitset that stores small sets inline, and only spills larger sets into a frame allocator. Copies of a
+// spilled bitset share the same storage.
+class InlineBitset
+{
+public:
+   static const std::size_t kInlineBits = 128;
+
+   InlineBitset() = default;
+
+   void reset(std::size_t newNumBits, bool value, FrameAllocator* frameAllocator)
+   {
+      numBits = newNumBits;
+      externalWords = nullptr;
+
+      std::size_t numWords = getNumWords();
+      if (numBits > kInlineBits)
+      {
+         ASSERT(frameAllocator, "A frame allocator is required for bitsets with more than %zu bits", kInlineBits);
+         externalWords = frameAllocator->allocate<uint64_t>(numWords);
+      }
+
+      uint64_t* words = getWords();
+      for (std::size_t i = 0; i < numWords; ++i)
+      {
+         words[i] = value ? ~uint64_t(0) : 0;
+      }
+   }
+
+   std::size_t size() const
+   {
+      return numBits;
+   }
+
+   bool test(std::size_t index) const
+   {
+      ASSERT(index < numBits);
+      return (getWords()[index / 64] & (uint64_t(1) << (index % 64))) != 0;
+   }
+
+   void set(std::size_t index, bool value)
+   {
+      ASSERT(index < numBits);
+
+      uint64_t bit = uint64_t(1) << (index % 64);
+      uint64_t& word = getWords()[index / 64];
+      word = value ? (word | bit) : (word & ~bit);
+   }
+
+private:
+   std::size_t getNumWords() const
+   {
+      return (numBits + 63) / 64;
+   }
+
+   uint64_t* getWords()
+   {
+      return externalWords ? externalWords : inlineWords.data();
+   }
+
+   const uint64_t* getWords() const
+   {
+      return externalWords ? externalWords : inlineWords.data();
+   }
+
+   std::array<uint64_t, kInlineBits / 64> inlineWords = {};
+   uint64_t* externalWords = nullptr;
+   std::size_t numBits = 0;
+};
@@ -0,0 +1,72 @@
+#include "Core/PoolAllocator.h"
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+
+PoolAllocator::PoolAllocator(std::size_t maxObjectSize, std::size_t slotsPerBlock)
+   : slotSize((std::max(maxObjectSize, sizeof(FreeSlot)) + kAlignment - 1) & ~(kAlignment - 1))
+   , slotsPerBlock(std::max<std::size_t>(slotsPerBlock, 1))
+{
+}
+
+PoolAllocator::~PoolAllocator()
+{
+   ASSERT(numAllocations == 0, "Destroying a pool allocator with %zu live allocations", numAllocations);
+}
+
+void* PoolAllocator::allocate()
+{
+   if (!freeList)
+   {
+      allocateBlock();
+   }
+
+   FreeSlot* slot = freeList;
+   freeList = slot->next;
+   ++numAllocations;
+   peakAllocations = std::max(peakAllocations, numAllocations);
+
+   return slot;
+}
+
+void PoolAllocator::deallocate(void* pointer)
+{
+   if (!pointer)
+   {
+      return;
+   }
+
+   ASSERT(numAllocations > 0);
+
+   FreeSlot* slot = static_cast<FreeSlot*>(pointer);
+   slot->next = freeList;
+   freeList = slot;
+   --numAllocations;
+}
+
+PoolStats PoolAllocator::getStats() const
+{
+   PoolStats stats;
+   stats.slotSize = slotSize;
+   stats.numAllocations = numAllocations;
+   stats.peakAllocations = peakAllocations;
+   stats.capacity = getCapacity();
+
+   return stats;
+}
+
+void PoolAllocator::allocateBlock()
+{
+   // The default operator new[] alignment is 16 bytes on all supported 64 bit platforms
+   blocks.push_back(UPtr<uint8_t[]>(new uint8_t[slotSize * slotsPerBlock]));
+   uint8_t* block = blocks.back().get();
+
+   // Link the slots in reverse, so that they are handed out in address order
+   for (std::size_t i = slotsPerBlock; i > 0; --i)
+   {
+      FreeSlot* slot = reinterpret_cast<FreeSlot*>(block + (i - 1) * slotSize);
+      slot->next = freeList;
+      freeList = slot;
+   }
+}
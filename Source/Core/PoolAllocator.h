@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Core/Pointers.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Snapshot of how much of a pool is in use
+struct PoolStats
+{
+   std::size_t slotSize = 0;
+   std::size_t numAllocations = 0;
+   std::size_t peakAllocations = 0;
+   std::size_t capacity = 0;
+
+   float getOccupancy() const
+   {
+      return capacity > 0 ? static_cast<float>(numAllocations) / capacity : 0.0f;
+   }
+};
+
+// Allocator for objects of a single (maximum) size. Slots are carved out of large blocks, so objects allocated together
+// end up next to each other in memory, and freed slots are reused before any new blocks are allocated. Not thread safe.
+class PoolAllocator
+{
+public:
+   static const std::size_t kAlignment = 16;
+
+   PoolAllocator(std::size_t maxObjectSize, std::size_t slotsPerBlock);
+   ~PoolAllocator();
+
+   PoolAllocator(const PoolAllocator& other) = delete;
+   PoolAllocator& operator=(const PoolAllocator& other) = delete;
+
+   void* allocate();
+   void deallocate(void* pointer);
+
+   std::size_t getSlotSize() const
+   {
+      return slotSize;
+   }
+
+   std::size_t getNumAllocations() const
+   {
+      return numAllocations;
+   }
+
+   std::size_t getCapacity() const
+   {
+      return blocks.size() * slotsPerBlock;
+   }
+
+   PoolStats getStats() const;
+
+private:
+   struct FreeSlot
+   {
+      FreeSlot* next;
+   };
+
+   void allocateBlock();
+
+   std::vector<UPtr<uint8_t[]>> blocks;
+   FreeSlot* freeList = nullptr;
+   std::size_t slotSize = 0;
+   std::size_t slotsPerBlock = 0;
+   std::size_t numAllocations = 0;
+   std::size_t peakAllocations = 0;
+};
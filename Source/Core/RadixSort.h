@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace RadixSort
+{
+   // Stable least significant digit radix sort over 64 bit keys, one byte at a time. Passes over bytes that are the same
+   // for every key are skipped, so keys that only use their low bits are cheaper to sort. The scratch buffer must hold at
+   // least count values.
+   template<typename T, typename KeyFunc>
+   void sort(T* values, T* scratch, std::size_t count, KeyFunc&& getKey)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "Radix sorted values are copied around as raw memory");
+
+      static const int kNumPasses = 8;
+      static const int kNumBuckets = 256;
+
+      if (count < 2)
+      {
+         return;
+      }
+
+      // Build the histograms for all passes up front, in a single read of the keys
+      std::array<std::array<std::size_t, kNumBuckets>, kNumPasses> histograms = {};
+      for (std::size_t i = 0; i < count; ++i)
+      {
+         uint64_t key = getKey(values[i]);
+         for (int pass = 0; pass < kNumPasses; ++pass)
+         {
+            ++histograms[pass][(key >> (pass * 8)) & 0xFF];
+         }
+      }
+
+      T* source = values;
+      T* destination = scratch;
+      for (int pass = 0; pass < kNumPasses; ++pass)
+      {
+         std::array<std::size_t, kNumBuckets>& histogram = histograms[pass];
+
+         uint64_t firstByte = (getKey(source[0]) >> (pass * 8)) & 0xFF;
+         if (histogram[firstByte] == count)
+         {
+            continue;
+         }
+
+         // Convert counts into starting offsets
+         std::size_t offset = 0;
+         for (std::size_t& bucket : histogram)
+         {
+            std::size_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+         }
+
+         for (std::size_t i = 0; i < count; ++i)
+         {
+            uint64_t byte = (getKey(source[i]) >> (pass * 8)) & 0xFF;
+            destination[histogram[byte]++] = source[i];
+         }
+
+         std::swap(source, destination);
+      }
+
+      if (source != values)
+      {
+         std::copy(source, source + count, values);
+      }
+   }
+}
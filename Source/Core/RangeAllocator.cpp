@@ -0,0 +1,91 @@
+#include "Core/RangeAllocator.h"
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+#include <iterator>
+
+RangeAllocator::RangeAllocator(uint32_t rangeCapacity)
+   : capacity(rangeCapacity)
+{
+   if (capacity > 0)
+   {
+      Range range;
+      range.size = capacity;
+      freeRanges.push_back(range);
+   }
+}
+
+uint32_t RangeAllocator::allocate(uint32_t size)
+{
+   if (size == 0)
+   {
+      return kInvalidOffset;
+   }
+
+   for (auto itr = freeRanges.begin(); itr != freeRanges.end(); ++itr)
+   {
+      if (itr->size >= size)
+      {
+         uint32_t offset = itr->offset;
+
+         itr->offset += size;
+         itr->size -= size;
+         if (itr->size == 0)
+         {
+            freeRanges.erase(itr);
+         }
+
+         usedSize += size;
+         return offset;
+      }
+   }
+
+   return kInvalidOffset;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t size)
+{
+   if (size == 0)
+   {
+      return;
+   }
+
+   ASSERT(offset <= capacity && size <= capacity - offset);
+   ASSERT(usedSize >= size);
+
+   auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), offset, [](const Range& range, uint32_t value)
+   {
+      return range.offset < value;
+   });
+
+   ASSERT(next == freeRanges.end() || offset + size <= next->offset, "Freeing a range that overlaps a free range");
+   ASSERT(next == freeRanges.begin() || std::prev(next)->offset + std::prev(next)->size <= offset, "Freeing a range that overlaps a free range");
+
+   usedSize -= size;
+
+   bool mergesWithPrevious = next != freeRanges.begin() && std::prev(next)->offset + std::prev(next)->size == offset;
+   bool mergesWithNext = next != freeRanges.end() && offset + size == next->offset;
+
+   if (mergesWithPrevious && mergesWithNext)
+   {
+      std::prev(next)->size += size + next->size;
+      freeRanges.erase(next);
+   }
+   else if (mergesWithPrevious)
+   {
+      std::prev(next)->size += size;
+   }
+   else if (mergesWithNext)
+   {
+      next->offset = offset;
+      next->size += size;
+   }
+   else
+   {
+      Range range;
+      range.offset = offset;
+      range.size = size;
+      freeRanges.insert(next, range);
+   }
+}
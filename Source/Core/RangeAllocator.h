@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// First fit allocator of ranges within a fixed size space (like the elements of a large GPU buffer). Only the free
+// ranges are tracked, and neighboring free ranges are merged as soon as they are freed, so a space that is emptied out
+// always ends up as a single free range again. Not thread safe.
+class RangeAllocator
+{
+public:
+   static const uint32_t kInvalidOffset = 0xFFFFFFFF;
+
+   explicit RangeAllocator(uint32_t rangeCapacity);
+
+   // Returns kInvalidOffset if there is no free range large enough
+   uint32_t allocate(uint32_t size);
+   void free(uint32_t offset, uint32_t size);
+
+   uint32_t getCapacity() const
+   {
+      return capacity;
+   }
+
+   uint32_t getUsedSize() const
+   {
+      return usedSize;
+   }
+
+private:
+   struct Range
+   {
+      uint32_t offset = 0;
+      uint32_t size = 0;
+   };
+
+   std::vector<Range> freeRanges; // Sorted by offset
+   uint32_t capacity = 0;
+   uint32_t usedSize = 0;
+};
@@ -0,0 +1,76 @@
+#include "Core/SizeClassAllocator.h"
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+#include <new>
+
+namespace
+{
+   std::size_t getSizeClass(std::size_t size)
+   {
+      return (std::max<std::size_t>(size, 1) - 1) / PoolAllocator::kAlignment;
+   }
+}
+
+SizeClassAllocator::SizeClassAllocator(std::size_t targetBlockSize)
+   : blockSize(targetBlockSize)
+{
+}
+
+SizeClassAllocator::~SizeClassAllocator()
+{
+   ASSERT(numHeapAllocations == 0, "Destroying a size class allocator with %zu live heap allocations", numHeapAllocations);
+}
+
+void* SizeClassAllocator::allocate(std::size_t size)
+{
+   if (size > kMaxPooledSize)
+   {
+      ++numHeapAllocations;
+      return ::operator new(size);
+   }
+
+   UPtr<PoolAllocator>& pool = pools[getSizeClass(size)];
+   if (!pool)
+   {
+      // Pools are only created for sizes that are actually used, and blocks hold more slots for smaller sizes
+      std::size_t slotSize = (getSizeClass(size) + 1) * PoolAllocator::kAlignment;
+      pool = std::make_unique<PoolAllocator>(slotSize, blockSize / slotSize);
+   }
+
+   return pool->allocate();
+}
+
+void SizeClassAllocator::deallocate(void* pointer, std::size_t size)
+{
+   if (!pointer)
+   {
+      return;
+   }
+
+   if (size > kMaxPooledSize)
+   {
+      ASSERT(numHeapAllocations > 0);
+
+      --numHeapAllocations;
+      ::operator delete(pointer);
+      return;
+   }
+
+   const UPtr<PoolAllocator>& pool = pools[getSizeClass(size)];
+   ASSERT(pool, "Deallocating from a size class that was never allocated from");
+
+   pool->deallocate(pointer);
+}
+
+void SizeClassAllocator::getStats(std::vector<PoolStats>& stats) const
+{
+   for (const UPtr<PoolAllocator>& pool : pools)
+   {
+      if (pool)
+      {
+         stats.push_back(pool->getStats());
+      }
+   }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Core/Pointers.h"
+#include "Core/PoolAllocator.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// Allocator for objects of many different sizes. Each size is rounded up to a multiple of the pool alignment, and served
+// from the pool for that size class, so objects of similar sizes share slots (and recycle each other's). Sizes over
+// kMaxPooledSize fall back to the heap. Not thread safe.
+class SizeClassAllocator
+{
+public:
+   static const std::size_t kMaxPooledSize = 512;
+   static const std::size_t kNumSizeClasses = kMaxPooledSize / PoolAllocator::kAlignment;
+
+   explicit SizeClassAllocator(std::size_t targetBlockSize);
+   ~SizeClassAllocator();
+
+   SizeClassAllocator(const SizeClassAllocator& other) = delete;
+   SizeClassAllocator& operator=(const SizeClassAllocator& other) = delete;
+
+   void* allocate(std::size_t size);
+
+   // Must be passed the same size that the allocation was made with
+   void deallocate(void* pointer, std::size_t size);
+
+   // Appends the stats of every size class that has been used
+   void getStats(std::vector<PoolStats>& stats) const;
+
+   std::size_t getNumHeapAllocations() const
+   {
+      return numHeapAllocations;
+   }
+
+private:
+   std::array<UPtr<PoolAllocator>, kNumSizeClasses> pools;
+   std::size_t blockSize = 0;
+   std::size_t numHeapAllocations = 0;
+};
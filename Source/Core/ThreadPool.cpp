@@ -0,0 +1,139 @@
+#include "Core/ThreadPool.h"
+
+#include "Core/Assert.h"
+
+namespace
+{
+   thread_local bool isExecutingJob = false;
+
+   std::size_t getDefaultNumWorkers()
+   {
+      unsigned int hardwareConcurrency = std::thread::hardware_concurrency();
+      return hardwareConcurrency > 1 ? hardwareConcurrency - 1 : 0;
+   }
+}
+
+// static
+ThreadPool& ThreadPool::instance()
+{
+   static ThreadPool threadPool(getDefaultNumWorkers());
+   return threadPool;
+}
+
+ThreadPool::ThreadPool(std::size_t numWorkers)
+{
+   workers.reserve(numWorkers);
+   for (std::size_t i = 0; i < numWorkers; ++i)
+   {
+      workers.emplace_back([this]()
+      {
+         workerLoop();
+      });
+   }
+}
+
+ThreadPool::~ThreadPool()
+{
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      shuttingDown = true;
+   }
+   jobAvailable.notify_all();
+
+   for (std::thread& worker : workers)
+   {
+      worker.join();
+   }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const JobFunc& func)
+{
+   if (count == 0)
+   {
+      return;
+   }
+
+   if (workers.empty() || count == 1 || isExecutingJob)
+   {
+      for (std::size_t i = 0; i < count; ++i)
+      {
+         func(i);
+      }
+
+      return;
+   }
+
+   std::lock_guard<std::mutex> submitLock(submitMutex);
+
+   Job job;
+   job.func = &func;
+   job.count = count;
+
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      currentJob = &job;
+      ++jobCounter;
+   }
+   jobAvailable.notify_all();
+
+   execute(job);
+
+   // Every index has been claimed at this point, but workers may still be running theirs. Once the job is cleared,
+   // workers that wake up late won't see it.
+   std::unique_lock<std::mutex> lock(mutex);
+   jobFinished.wait(lock, [&job]()
+   {
+      return job.numActiveWorkers == 0;
+   });
+   currentJob = nullptr;
+}
+
+// static
+void ThreadPool::execute(Job& job)
+{
+   bool wasExecutingJob = isExecutingJob;
+   isExecutingJob = true;
+
+   for (std::size_t index = job.nextIndex++; index < job.count; index = job.nextIndex++)
+   {
+      (*job.func)(index);
+   }
+
+   isExecutingJob = wasExecutingJob;
+}
+
+void ThreadPool::workerLoop()
+{
+   uint64_t lastJob = 0;
+   while (true)
+   {
+      Job* job = nullptr;
+
+      {
+         std::unique_lock<std::mutex> lock(mutex);
+         jobAvailable.wait(lock, [this, lastJob]()
+         {
+            return shuttingDown || (currentJob && jobCounter != lastJob);
+         });
+
+         if (shuttingDown)
+         {
+            break;
+         }
+
+         lastJob = jobCounter;
+         job = currentJob;
+         ++job->numActiveWorkers;
+      }
+
+      execute(*job);
+
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+
+         ASSERT(job->numActiveWorkers > 0);
+         --job->numActiveWorkers;
+      }
+      jobFinished.notify_all();
+   }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+   using JobFunc = std::function<void(std::size_t)>;
+
+   // Shared pool, with one worker per hardware thread (minus one for the calling thread)
+   static ThreadPool& instance();
+
+   explicit ThreadPool(std::size_t numWorkers);
+   ~ThreadPool();
+
+   ThreadPool(const ThreadPool& other) = delete;
+   ThreadPool& operator=(const ThreadPool& other) = delete;
+
+   // Includes the calling thread, which takes part in all work
+   std::size_t getNumThreads() const
+   {
+      return workers.size() + 1;
+   }
+
+   // Calls func(index) for every index in [0, count), spread over the workers and the calling thread. Returns once all
+   // calls have completed. Calls made from within a job are run serially on the calling thread.
+   void parallelFor(std::size_t count, const JobFunc& func);
+
+private:
+   struct Job
+   {
+      const JobFunc* func = nullptr;
+      std::size_t count = 0;
+      std::atomic<std::size_t> nextIndex = { 0 };
+      std::size_t numActiveWorkers = 0;
+   };
+
+   static void execute(Job& job);
+
+   void workerLoop();
+
+   std::vector<std::thread> workers;
+
+   std::mutex submitMutex;
+   std::mutex mutex;
+   std::condition_variable jobAvailable;
+   std::condition_variable jobFinished;
+
+   Job* currentJob = nullptr;
+   uint64_t jobCounter = 0;
+   bool shuttingDown = false;
+};
@@ -63,6 +63,20 @@ void BufferObject::updateData(BufferBindingTarget target, GLintptr offset, GLsiz
    glBufferSubData(static_cast<GLenum>(target), offset, size, data);
 }
 
+#if SWAP_GL_BUFFER_STORAGE_SUPPORTED
+void BufferObject::setStorage(BufferBindingTarget target, GLsizeiptr size, const GLvoid* data, GLbitfield flags)
+{
+   ASSERT(size > 0);
+
+   // Immutable storage can't be respecified, so a new buffer is needed every time
+   release();
+   glGenBuffers(1, &id);
+
+   glBindBuffer(static_cast<GLenum>(target), id);
+   glBufferStorage(static_cast<GLenum>(target), size, data, flags);
+}
+#endif // SWAP_GL_BUFFER_STORAGE_SUPPORTED
+
 VertexBufferObject::VertexBufferObject(VertexAttribute vertexAttribute)
    : attribute(vertexAttribute)
 {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Graphics/GraphicsDefines.h"
 #include "Graphics/GraphicsResource.h"
 
 #include <glad/gl.h>
@@ -45,6 +46,11 @@ public:
 
    void setData(BufferBindingTarget target, GLsizeiptr size, const GLvoid* data, BufferUsage usage);
    void updateData(BufferBindingTarget target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+#if SWAP_GL_BUFFER_STORAGE_SUPPORTED
+   // Allocates immutable storage (which can't be resized, only released)
+   void setStorage(BufferBindingTarget target, GLsizeiptr size, const GLvoid* data, GLbitfield flags);
+#endif // SWAP_GL_BUFFER_STORAGE_SUPPORTED
 };
 
 enum class VertexAttribute : GLuint
@@ -54,7 +60,12 @@ enum class VertexAttribute : GLuint
    TexCoord = 2,
    Tangent = 3,
    Bitangent = 4,
-   Color = 5
+   Color = 5,
+
+   // Per instance attributes (see InstanceBuffer), matrices take up one location per column
+   InstanceLocalToWorld = 6,
+   InstanceLocalToNormal = 10,
+   InstanceCustomData = 13
 };
 
 class VertexBufferObject : public BufferObject
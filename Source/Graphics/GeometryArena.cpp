@@ -0,0 +1,156 @@
+#include "Graphics/GeometryArena.h"
+
+#include "Core/Assert.h"
+#include "Graphics/GraphicsContext.h"
+#include "Graphics/Mesh.h"
+
+#include <vector>
+
+namespace
+{
+   struct AttributeFormat
+   {
+      VertexAttribute attribute;
+      GLint valueSize;
+   };
+
+   const std::array<AttributeFormat, 6> kAttributeFormats =
+   { {
+      { VertexAttribute::Position, 3 },
+      { VertexAttribute::Normal, 3 },
+      { VertexAttribute::TexCoord, 2 },
+      { VertexAttribute::Tangent, 3 },
+      { VertexAttribute::Bitangent, 3 },
+      { VertexAttribute::Color, 4 }
+   } };
+
+   std::array<const MeshAttributeData<GLfloat>*, 6> getAttributeData(const MeshData& data)
+   {
+      return { &data.positions, &data.normals, &data.texCoords, &data.tangents, &data.bitangents, &data.colors };
+   }
+}
+
+GeometryArena::GeometryArena(uint32_t vertexCapacity, uint32_t indexCapacity)
+   : GraphicsResource(GraphicsResourceType::VertexArray)
+   , vertexRanges(vertexCapacity)
+   , indexRanges(indexCapacity)
+{
+   static_assert(kAttributeFormats.size() == kNumAttributes, "Every attribute needs a format");
+
+   glGenVertexArrays(1, &id);
+   bind();
+
+   elementBufferObject.setData(BufferBindingTarget::ElementArray, static_cast<GLsizeiptr>(indexCapacity) * sizeof(GLuint), nullptr, BufferUsage::StaticDraw);
+
+   for (std::size_t i = 0; i < kNumAttributes; ++i)
+   {
+      const AttributeFormat& format = kAttributeFormats[i];
+      GLuint index = static_cast<GLuint>(format.attribute);
+
+      attributeBufferObjects[i].setData(BufferBindingTarget::Array, static_cast<GLsizeiptr>(vertexCapacity) * format.valueSize * sizeof(GLfloat), nullptr, BufferUsage::StaticDraw);
+      glEnableVertexAttribArray(index);
+      glVertexAttribPointer(index, format.valueSize, GL_FLOAT, GL_FALSE, 0, nullptr);
+   }
+}
+
+GeometryArena::~GeometryArena()
+{
+   ASSERT(vertexRanges.getUsedSize() == 0 && indexRanges.getUsedSize() == 0, "Destroying a geometry arena that still contains mesh sections");
+
+   if (id != 0)
+   {
+      GraphicsContext::current().onVertexArrayDestroyed(id);
+
+      glDeleteVertexArrays(1, &id);
+      id = 0;
+   }
+}
+
+// static
+bool GeometryArena::canStore(const MeshData& data)
+{
+   std::size_t numVertices = data.positions.valueSize > 0 ? data.positions.values.size() / data.positions.valueSize : 0;
+   if (numVertices == 0 || data.indices.empty())
+   {
+      return false;
+   }
+
+   // Missing attributes are fine, but present ones need to match the arena's format
+   std::array<const MeshAttributeData<GLfloat>*, 6> attributeData = getAttributeData(data);
+   for (std::size_t i = 0; i < kNumAttributes; ++i)
+   {
+      const MeshAttributeData<GLfloat>& attribute = *attributeData[i];
+      if (!attribute.values.empty() && (attribute.valueSize != kAttributeFormats[i].valueSize || attribute.values.size() != numVertices * kAttributeFormats[i].valueSize))
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool GeometryArena::allocate(const MeshData& data, Allocation& allocation)
+{
+   if (!canStore(data))
+   {
+      return false;
+   }
+
+   uint32_t numVertices = static_cast<uint32_t>(data.positions.values.size() / data.positions.valueSize);
+   uint32_t numIndices = static_cast<uint32_t>(data.indices.size());
+
+   uint32_t firstVertex = vertexRanges.allocate(numVertices);
+   if (firstVertex == RangeAllocator::kInvalidOffset)
+   {
+      return false;
+   }
+
+   uint32_t firstIndex = indexRanges.allocate(numIndices);
+   if (firstIndex == RangeAllocator::kInvalidOffset)
+   {
+      vertexRanges.free(firstVertex, numVertices);
+      return false;
+   }
+
+   allocation.firstVertex = firstVertex;
+   allocation.numVertices = numVertices;
+   allocation.firstIndex = firstIndex;
+   allocation.numIndices = numIndices;
+
+   // The element array binding belongs to the vertex array, so make sure it's ours that gets updated
+   bind();
+   elementBufferObject.updateData(BufferBindingTarget::ElementArray, static_cast<GLintptr>(firstIndex) * sizeof(GLuint), data.indices.size_bytes(), data.indices.data());
+
+   // Missing attributes are zeroed out, so that shaders never read whatever was left behind by a previous allocation
+   std::vector<GLfloat> zeros;
+   std::array<const MeshAttributeData<GLfloat>*, 6> attributeData = getAttributeData(data);
+   for (std::size_t i = 0; i < kNumAttributes; ++i)
+   {
+      const MeshAttributeData<GLfloat>& attribute = *attributeData[i];
+      std::size_t valueSize = kAttributeFormats[i].valueSize;
+
+      const GLfloat* values = attribute.values.data();
+      if (attribute.values.empty())
+      {
+         zeros.resize(numVertices * valueSize, 0.0f);
+         values = zeros.data();
+      }
+
+      attributeBufferObjects[i].updateData(BufferBindingTarget::Array, static_cast<GLintptr>(firstVertex) * valueSize * sizeof(GLfloat), numVertices * valueSize * sizeof(GLfloat), values);
+   }
+
+   return true;
+}
+
+void GeometryArena::free(const Allocation& allocation)
+{
+   vertexRanges.free(allocation.firstVertex, allocation.numVertices);
+   indexRanges.free(allocation.firstIndex, allocation.numIndices);
+}
+
+void GeometryArena::bind() const
+{
+   ASSERT(id != 0);
+
+   GraphicsContext::current().bindVertexArray(id);
+}
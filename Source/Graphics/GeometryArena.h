@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Core/RangeAllocator.h"
+#include "Graphics/BufferObject.h"
+#include "Graphics/GraphicsResource.h"
+
+#include <glad/gl.h>
+
+#include <array>
+#include <cstdint>
+
+struct MeshData;
+
+// Large shared vertex and index buffers, that mesh sections can be placed in instead of owning their own. Every section
+// in an arena uses the same vertex array, so drawing them doesn't change any vertex state, and consecutive draws can be
+// submitted together with a single multi draw call.
+//
+// Each attribute has a fixed number of components in the arena (positions, normals, tangents and bitangents have 3,
+// texture coordinates 2, and colors 4). Mesh data that doesn't match can't be placed in an arena.
+class GeometryArena : public GraphicsResource
+{
+public:
+   // Offsets and counts are in vertices / indices, not bytes
+   struct Allocation
+   {
+      uint32_t firstVertex = 0;
+      uint32_t numVertices = 0;
+      uint32_t firstIndex = 0;
+      uint32_t numIndices = 0;
+   };
+
+   GeometryArena(uint32_t vertexCapacity, uint32_t indexCapacity);
+   GeometryArena(const GeometryArena& other) = delete;
+   GeometryArena(GeometryArena&& other) = delete;
+   ~GeometryArena();
+   GeometryArena& operator=(const GeometryArena& other) = delete;
+   GeometryArena& operator=(GeometryArena&& other) = delete;
+
+   static bool canStore(const MeshData& data);
+
+   // Uploads the data into free space. Returns false if the data can't be stored, or if there isn't enough space left.
+   bool allocate(const MeshData& data, Allocation& allocation);
+   void free(const Allocation& allocation);
+
+   void bind() const;
+
+   uint32_t getVertexCapacity() const
+   {
+      return vertexRanges.getCapacity();
+   }
+
+   uint32_t getNumUsedVertices() const
+   {
+      return vertexRanges.getUsedSize();
+   }
+
+   uint32_t getIndexCapacity() const
+   {
+      return indexRanges.getCapacity();
+   }
+
+   uint32_t getNumUsedIndices() const
+   {
+      return indexRanges.getUsedSize();
+   }
+
+private:
+   static const std::size_t kNumAttributes = 6;
+
+   RangeAllocator vertexRanges;
+   RangeAllocator indexRanges;
+
+   BufferObject elementBufferObject;
+   std::array<BufferObject, kNumAttributes> attributeBufferObjects;
+};
@@ -406,19 +406,42 @@ void GraphicsContext::activateAndBindTexture(int textureUnit, Tex::Target target
    }
 }
 
-void GraphicsContext::drawElements(PrimitiveMode mode, GLsizei count, IndexType type, const GLvoid* indices)
+void GraphicsContext::drawElements(PrimitiveMode mode, GLsizei count, IndexType type, const GLvoid* indices, GLint baseVertex)
 {
-   if (rasterizerStateDirty)
+   commitRasterizerState();
+
+   if (baseVertex == 0)
    {
-      const RasterizerState& newState = rasterizerStateStack.empty() ? baseRasterizerState : rasterizerStateStack.back();
-      setRasterizerState(newState, currentRasterizerState);
-      currentRasterizerState = newState;
+      glDrawElements(static_cast<GLenum>(mode), count, static_cast<GLenum>(type), indices);
+   }
+   else
+   {
+      glDrawElementsBaseVertex(static_cast<GLenum>(mode), count, static_cast<GLenum>(type), indices, baseVertex);
+   }
+}
 
-      rasterizerStateDirty = false;
+void GraphicsContext::drawElementsInstanced(PrimitiveMode mode, GLsizei count, IndexType type, const GLvoid* indices, GLsizei instanceCount, GLint baseVertex)
+{
+   commitRasterizerState();
+
+   if (baseVertex == 0)
+   {
+      glDrawElementsInstanced(static_cast<GLenum>(mode), count, static_cast<GLenum>(type), indices, instanceCount);
+   }
+   else
+   {
+      glDrawElementsInstancedBaseVertex(static_cast<GLenum>(mode), count, static_cast<GLenum>(type), indices, instanceCount, baseVertex);
    }
+}
+
+#if SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
+void GraphicsContext::multiDrawElementsIndirect(PrimitiveMode mode, IndexType type, const GLvoid* indirect, GLsizei drawCount)
+{
+   commitRasterizerState();
 
-   glDrawElements(static_cast<GLenum>(mode), count, static_cast<GLenum>(type), indices);
+   glMultiDrawElementsIndirect(static_cast<GLenum>(mode), static_cast<GLenum>(type), indirect, drawCount, 0);
 }
+#endif // SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
 
 void GraphicsContext::pushRasterizerState(const RasterizerState& state)
 {
@@ -483,6 +506,18 @@ void GraphicsContext::onTextureDestroyed(Tex::Target target, GLuint texture)
    activeTexture(cachedActiveTextureUnit);
 }
 
+void GraphicsContext::commitRasterizerState()
+{
+   if (rasterizerStateDirty)
+   {
+      const RasterizerState& newState = rasterizerStateStack.empty() ? baseRasterizerState : rasterizerStateStack.back();
+      setRasterizerState(newState, currentRasterizerState);
+      currentRasterizerState = newState;
+
+      rasterizerStateDirty = false;
+   }
+}
+
 // static
 void GraphicsContext::setCurrent(GraphicsContext* context)
 {
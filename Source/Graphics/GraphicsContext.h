@@ -3,6 +3,7 @@
 #include "Core/Assert.h"
 #include "Core/Pointers.h"
 #include "Graphics/Framebuffer.h"
+#include "Graphics/GraphicsDefines.h"
 #include "Graphics/RasterizerState.h"
 #include "Graphics/TextureInfo.h"
 #include "Graphics/UniformBufferObject.h"
@@ -36,6 +37,16 @@ enum class IndexType : GLenum
    UnsignedInt = GL_UNSIGNED_INT
 };
 
+// Layout of the commands read from the draw indirect buffer by multiDrawElementsIndirect()
+struct DrawElementsIndirectCommand
+{
+   GLuint count = 0;
+   GLuint instanceCount = 0;
+   GLuint firstIndex = 0;
+   GLint baseVertex = 0;
+   GLuint baseInstance = 0;
+};
+
 class GraphicsContext
 {
 public:
@@ -78,7 +89,11 @@ public:
    void bindTexture(Tex::Target target, GLuint texture);
    void activateAndBindTexture(int textureUnit, Tex::Target target, GLuint texture);
 
-   void drawElements(PrimitiveMode mode, GLsizei count, IndexType type, const GLvoid* indices);
+   void drawElements(PrimitiveMode mode, GLsizei count, IndexType type, const GLvoid* indices, GLint baseVertex = 0);
+   void drawElementsInstanced(PrimitiveMode mode, GLsizei count, IndexType type, const GLvoid* indices, GLsizei instanceCount, GLint baseVertex = 0);
+#if SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
+   void multiDrawElementsIndirect(PrimitiveMode mode, IndexType type, const GLvoid* indirect, GLsizei drawCount);
+#endif // SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
 
    void pushRasterizerState(const RasterizerState& state);
    void popRasterizerState();
@@ -91,6 +106,8 @@ public:
 private:
    using TextureBindings = std::array<GLuint, 25>;
 
+   void commitRasterizerState();
+
    static void setCurrent(GraphicsContext* context);
    static void onDestroy(GraphicsContext* context);
 
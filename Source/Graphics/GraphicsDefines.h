@@ -9,3 +9,5 @@
 
 #define SWAP_GL_OBJECT_LABEL_SUPPORTED (SWAP_DESIRED_GL_VERSION_MAJOR > 4 || (SWAP_DESIRED_GL_VERSION_MAJOR == 4 && SWAP_DESIRED_GL_VERSION_MINOR >= 3))
 #define SWAP_GL_DEBUG_CONTEXT_SUPPORTED (SWAP_DESIRED_GL_VERSION_MAJOR > 4 || (SWAP_DESIRED_GL_VERSION_MAJOR == 4 && SWAP_DESIRED_GL_VERSION_MINOR >= 3))
+#define SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED (SWAP_DESIRED_GL_VERSION_MAJOR > 4 || (SWAP_DESIRED_GL_VERSION_MAJOR == 4 && SWAP_DESIRED_GL_VERSION_MINOR >= 3))
+#define SWAP_GL_BUFFER_STORAGE_SUPPORTED (SWAP_DESIRED_GL_VERSION_MAJOR > 4 || (SWAP_DESIRED_GL_VERSION_MAJOR == 4 && SWAP_DESIRED_GL_VERSION_MINOR >= 4))
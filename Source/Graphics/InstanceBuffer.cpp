@@ -0,0 +1,152 @@
+#include "Graphics/InstanceBuffer.h"
+
+#include "Core/Assert.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+#if SWAP_GL_BUFFER_STORAGE_SUPPORTED
+   const std::size_t kInitialFrameCapacity = 4096;
+   const GLbitfield kStorageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+   const GLuint64 kFenceTimeout = 1000000000; // 1 second, in nanoseconds
+
+   void waitForFence(GLsync& fence)
+   {
+      if (fence)
+      {
+         GLenum result = GL_TIMEOUT_EXPIRED;
+         do
+         {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeout);
+         } while (result == GL_TIMEOUT_EXPIRED);
+         ASSERT(result != GL_WAIT_FAILED);
+
+         glDeleteSync(fence);
+         fence = nullptr;
+      }
+   }
+#endif // SWAP_GL_BUFFER_STORAGE_SUPPORTED
+
+   void setFloatAttribute(VertexAttribute attribute, int column, GLint size, std::size_t offset)
+   {
+      GLuint index = static_cast<GLuint>(attribute) + column;
+
+      glEnableVertexAttribArray(index);
+      glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, sizeof(InstanceData), reinterpret_cast<const GLvoid*>(offset));
+      glVertexAttribDivisor(index, 1);
+   }
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+#if SWAP_GL_BUFFER_STORAGE_SUPPORTED
+   releaseStorage();
+#endif // SWAP_GL_BUFFER_STORAGE_SUPPORTED
+}
+
+void InstanceBuffer::beginFrame()
+{
+#if SWAP_GL_BUFFER_STORAGE_SUPPORTED
+   if (mappedInstances)
+   {
+      // Everything the previous frame submitted that reads from its region has been issued by now
+      ASSERT(!frameFences[frameIndex]);
+      frameFences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+      frameIndex = (frameIndex + 1) % kNumFramesInFlight;
+      waitForFence(frameFences[frameIndex]);
+   }
+
+   frameSize = 0;
+#endif // SWAP_GL_BUFFER_STORAGE_SUPPORTED
+}
+
+void InstanceBuffer::setData(gsl::span<const InstanceData> instances)
+{
+   if (instances.empty())
+   {
+      return;
+   }
+
+#if SWAP_GL_BUFFER_STORAGE_SUPPORTED
+   std::size_t numInstances = static_cast<std::size_t>(instances.size());
+   if (frameSize + numInstances > frameCapacity)
+   {
+      // Draws that were already submitted keep the old buffer alive until they are done with it
+      allocateStorage(std::max(frameCapacity * 2, std::max(numInstances, kInitialFrameCapacity)));
+   }
+
+   std::size_t firstInstance = frameIndex * frameCapacity + frameSize;
+   std::memcpy(mappedInstances + firstInstance, instances.data(), instances.size_bytes());
+
+   dataOffset = firstInstance * sizeof(InstanceData);
+   frameSize += numInstances;
+#else
+   bufferObject.setData(BufferBindingTarget::Array, instances.size_bytes(), instances.data(), BufferUsage::StreamDraw);
+   dataOffset = 0;
+#endif // SWAP_GL_BUFFER_STORAGE_SUPPORTED
+}
+
+void InstanceBuffer::bindAttributes(GLsizei firstInstance) const
+{
+   ASSERT(bufferObject.getId() != 0);
+
+   // Attribute pointers (unlike the array buffer binding) are vertex array state, so they need to be set for every draw
+   glBindBuffer(GL_ARRAY_BUFFER, bufferObject.getId());
+
+   std::size_t baseOffset = dataOffset + static_cast<std::size_t>(firstInstance) * sizeof(InstanceData);
+   for (int column = 0; column < 4; ++column)
+   {
+      setFloatAttribute(VertexAttribute::InstanceLocalToWorld, column, 4, baseOffset + offsetof(InstanceData, localToWorld) + column * sizeof(glm::vec4));
+   }
+   for (int column = 0; column < 3; ++column)
+   {
+      setFloatAttribute(VertexAttribute::InstanceLocalToNormal, column, 3, baseOffset + offsetof(InstanceData, localToNormal) + column * sizeof(glm::vec3));
+   }
+
+   GLuint customDataIndex = static_cast<GLuint>(VertexAttribute::InstanceCustomData);
+   glEnableVertexAttribArray(customDataIndex);
+   glVertexAttribIPointer(customDataIndex, 2, GL_UNSIGNED_INT, sizeof(InstanceData), reinterpret_cast<const GLvoid*>(baseOffset + offsetof(InstanceData, customData)));
+   glVertexAttribDivisor(customDataIndex, 1);
+}
+
+#if SWAP_GL_BUFFER_STORAGE_SUPPORTED
+void InstanceBuffer::allocateStorage(std::size_t newFrameCapacity)
+{
+   releaseStorage();
+
+   GLsizeiptr size = static_cast<GLsizeiptr>(newFrameCapacity * kNumFramesInFlight * sizeof(InstanceData));
+   bufferObject.setStorage(BufferBindingTarget::Array, size, nullptr, kStorageFlags);
+   mappedInstances = static_cast<InstanceData*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, kStorageFlags));
+   ASSERT(mappedInstances);
+
+   // Nothing has been written to the new buffer yet, so the rest of the frame can start from the beginning of it
+   frameCapacity = newFrameCapacity;
+   frameSize = 0;
+}
+
+void InstanceBuffer::releaseStorage()
+{
+   // The fences only guard regions of the old buffer, which the GL keeps alive until it is no longer in use
+   for (GLsync& fence : frameFences)
+   {
+      if (fence)
+      {
+         glDeleteSync(fence);
+         fence = nullptr;
+      }
+   }
+
+   if (mappedInstances)
+   {
+      glBindBuffer(GL_ARRAY_BUFFER, bufferObject.getId());
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+      mappedInstances = nullptr;
+   }
+
+   bufferObject.release();
+   frameCapacity = 0;
+}
+#endif // SWAP_GL_BUFFER_STORAGE_SUPPORTED
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Graphics/BufferObject.h"
+#include "Graphics/GraphicsDefines.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <gsl/span>
+
+#include <array>
+#include <cstddef>
+
+// Per instance data of instanced draws, read by shaders as vertex attributes (see InstanceCommon.glsl)
+struct InstanceData
+{
+   glm::mat4 localToWorld;
+   glm::mat3 localToNormal;
+   glm::uvec2 customData; // Meaning depends on the shader (the forward shaders read their light masks from it)
+};
+
+static_assert(sizeof(InstanceData) == 27 * 4, "Instance data must be tightly packed to match its attribute layout");
+
+// Holds the instances of every draw in a pass. Instances are uploaded all at once, and each draw then points the
+// instance attributes of its vertex array at its own range within the buffer.
+//
+// Where buffer storage is supported, the buffer is persistently mapped and split into one region per frame in flight.
+// Every pass of a frame appends its instances to the frame's region, and a fence is placed at the end of each frame so
+// that a region is only written again once the GPU is done reading it. Otherwise, each upload orphans the previous one.
+class InstanceBuffer
+{
+public:
+   InstanceBuffer() = default;
+   InstanceBuffer(const InstanceBuffer& other) = delete;
+   InstanceBuffer(InstanceBuffer&& other) = delete;
+   ~InstanceBuffer();
+   InstanceBuffer& operator=(const InstanceBuffer& other) = delete;
+   InstanceBuffer& operator=(InstanceBuffer&& other) = delete;
+
+   // Must be called once at the start of every frame, before any instances are uploaded
+   void beginFrame();
+
+   // Replaces the instances that draws read from (previous uploads stay valid for the draws already submitted)
+   void setData(gsl::span<const InstanceData> instances);
+
+   // Must be called with the vertex array that will be drawn bound
+   void bindAttributes(GLsizei firstInstance) const;
+
+private:
+   BufferObject bufferObject;
+   std::size_t dataOffset = 0; // Of the most recent upload, in bytes
+
+#if SWAP_GL_BUFFER_STORAGE_SUPPORTED
+   static const std::size_t kNumFramesInFlight = 3;
+
+   void allocateStorage(std::size_t newFrameCapacity);
+   void releaseStorage();
+
+   InstanceData* mappedInstances = nullptr;
+   std::size_t frameCapacity = 0; // In instances, per frame
+   std::size_t frameIndex = 0;
+   std::size_t frameSize = 0; // Instances written so far this frame
+   std::array<GLsync, kNumFramesInFlight> frameFences = {};
+#endif // SWAP_GL_BUFFER_STORAGE_SUPPORTED
+};
@@ -1,13 +1,35 @@
 #include "Graphics/Material.h"
 
 #include "Core/Assert.h"
+#include "Graphics/DrawingContext.h"
 #include "Graphics/MaterialParameter.h"
 #include "Graphics/ShaderProgram.h"
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
+#include <cstring>
+
 namespace
 {
+   const char* kConstantsBlockName = "MaterialConstants";
+
+   struct MaterialConstantInfo
+   {
+      const char* name;
+      UniformType type;
+      std::size_t offset;
+      std::size_t size;
+   };
+
+   const std::array<MaterialConstantInfo, 4> kMaterialConstants =
+   { {
+      { "uMaterial.diffuseColor", UniformType::Float3, offsetof(MaterialConstants, diffuseColor), sizeof(glm::vec3) },
+      { "uMaterial.shininess", UniformType::Float, offsetof(MaterialConstants, shininess), sizeof(float) },
+      { "uMaterial.specularColor", UniformType::Float3, offsetof(MaterialConstants, specularColor), sizeof(glm::vec3) },
+      { "uMaterial.emissiveColor", UniformType::Float3, offsetof(MaterialConstants, emissiveColor), sizeof(glm::vec3) }
+   } };
+
    const std::array<CommonMaterialParameter, 3> kCommonMaterialParameters =
    {
       {
@@ -25,9 +47,9 @@ namespace CommonMaterialParameterNames
       static const std::array<std::string, 3> kCommonMaterialParameterNames =
       {
          {
-            "uMaterial.diffuseTexture",
-            "uMaterial.specularTexture",
-            "uMaterial.normalTexture"
+            "uDiffuseTexture",
+            "uSpecularTexture",
+            "uNormalTexture"
          }
       };
 
@@ -48,17 +70,36 @@ Material& Material::operator=(const Material& other)
       parameters.emplace(pair.first, pair.second->clone());
    }
 
+   compileParameters();
+
    commonMaterialParameterUsage = other.commonMaterialParameterUsage;
    blendMode = other.blendMode;
 
+   // The buffer isn't copied, the constants get uploaded to this material's own buffer the next time it is applied
+   constants = other.constants;
+   constantsDirty = true;
+
    return *this;
 }
 
+// static
+void Material::bindConstantsBlock(ShaderProgram& program)
+{
+   program.bindUniformBlock(kConstantsBlockName, UniformBufferObjectIndex::Material);
+}
+
 void Material::apply(DrawingContext& context) const
 {
-   for (auto& pair : parameters)
+   ASSERT(context.program);
+
+   if (context.program->hasUniformBlockBinding(UniformBufferObjectIndex::Material))
+   {
+      bindConstants();
+   }
+
+   for (const MaterialParameterBase* parameter : enabledParameters)
    {
-      pair.second->apply(context);
+      parameter->apply(context);
    }
 }
 
@@ -69,6 +110,10 @@ bool Material::isParameterEnabled(const std::string& name) const
    {
       return location->second->isEnabled();
    }
+   else if (findConstant(name) >= 0)
+   {
+      return true;
+   }
    else
    {
       ASSERT(false, "Material parameter with given name doesn't exist: %s", name.c_str());
@@ -82,6 +127,11 @@ void Material::setParameterEnabled(const std::string& name, bool enabled)
    if (location != parameters.end())
    {
       location->second->setEnabled(enabled);
+      compileParameters();
+   }
+   else if (findConstant(name) >= 0)
+   {
+      ASSERT(enabled, "Material constants can't be disabled: %s", name.c_str());
    }
    else
    {
@@ -121,7 +171,68 @@ Material::ParameterMap::iterator Material::findOrCreateParameter(const std::stri
       {
          commonMaterialParameterUsage[i] = commonMaterialParameterUsage[i] || name == CommonMaterialParameterNames::get(kCommonMaterialParameters[i]);
       }
+
+      compileParameters();
    }
 
    return location;
 }
+
+void Material::compileParameters()
+{
+   enabledParameters.clear();
+   enabledParameters.reserve(parameters.size());
+
+   for (const auto& pair : parameters)
+   {
+      if (pair.second->isEnabled())
+      {
+         enabledParameters.push_back(pair.second.get());
+      }
+   }
+}
+
+// static
+int Material::findConstant(const std::string& name)
+{
+   for (std::size_t i = 0; i < kMaterialConstants.size(); ++i)
+   {
+      if (name == kMaterialConstants[i].name)
+      {
+         return static_cast<int>(i);
+      }
+   }
+
+   return -1;
+}
+
+bool Material::setConstant(int index, UniformType type, const void* value)
+{
+   const MaterialConstantInfo& info = kMaterialConstants[index];
+   if (type != info.type)
+   {
+      ASSERT(false, "Invalid type for material constant %s: %u", info.name, static_cast<unsigned int>(type));
+      return false;
+   }
+
+   std::memcpy(reinterpret_cast<uint8_t*>(&constants) + info.offset, value, info.size);
+   constantsDirty = true;
+
+   return true;
+}
+
+void Material::bindConstants() const
+{
+   if (!constantsBuffer)
+   {
+      constantsBuffer = std::make_unique<UniformBufferObject>(kConstantsBlockName);
+      constantsBuffer->setData(&constants, sizeof(constants));
+   }
+   else if (constantsDirty)
+   {
+      constantsBuffer->updateData(&constants, sizeof(constants));
+   }
+   constantsDirty = false;
+
+   constantsBuffer->bindTo(UniformBufferObjectIndex::Material);
+}
@@ -7,11 +7,16 @@
 #include "Core/Pointers.h"
 #include "Graphics/MaterialParameter.h"
 #include "Graphics/Uniform.h"
+#include "Graphics/UniformBufferObject.h"
+
+#include <glm/glm.hpp>
 
 #include <array>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+class ShaderProgram;
 struct DrawingContext;
 
 enum class BlendMode : uint8_t
@@ -32,6 +37,22 @@ namespace CommonMaterialParameterNames
    const std::string& get(CommonMaterialParameter parameter);
 }
 
+// Matches the MaterialConstants block in MaterialCommon.glsl (std140 layout)
+struct MaterialConstants
+{
+   glm::vec3 diffuseColor = glm::vec3(0.0f);
+   float shininess = 0.0f;
+   glm::vec3 specularColor = glm::vec3(0.0f);
+   float padding0 = 0.0f;
+   glm::vec3 emissiveColor = glm::vec3(0.0f);
+   float padding1 = 0.0f;
+};
+
+static_assert(sizeof(MaterialConstants) == 48, "MaterialConstants doesn't match the std140 layout of its block");
+
+// Parameters named after a member of the MaterialConstants block ("uMaterial.diffuseColor" etc.) are packed into a uniform
+// buffer that belongs to the material, so applying the material only needs to bind that buffer. All other parameters
+// (textures, and the parameters of materials that aren't surface materials) are set as individual uniforms.
 class Material
 {
 public:
@@ -42,11 +63,20 @@ public:
    Material& operator=(const Material& other);
    Material& operator=(Material&& other) = default;
 
+   // Needs to be called once for every program that reads material constants
+   static void bindConstantsBlock(ShaderProgram& program);
+
    void apply(DrawingContext& context) const;
 
    template<typename T>
    bool setParameter(const std::string& name, const T& value)
    {
+      int constantIndex = findConstant(name);
+      if (constantIndex >= 0)
+      {
+         return setConstant(constantIndex, getUniformType<T>(), &value);
+      }
+
       auto location = findOrCreateParameter(name, getUniformType<T>());
       ASSERT(location != parameters.end());
 
@@ -56,9 +86,10 @@ public:
    bool isParameterEnabled(const std::string& name) const;
    void setParameterEnabled(const std::string& name, bool enabled);
 
+   // Constants always exist (they default to zero)
    bool hasParameter(const std::string& name) const
    {
-      return parameters.count(name) > 0;
+      return parameters.count(name) > 0 || findConstant(name) >= 0;
    }
 
    bool hasCommonParameter(CommonMaterialParameter parameter) const
@@ -80,8 +111,19 @@ private:
    using ParameterMap = std::unordered_map<std::string, UPtr<MaterialParameterBase>>;
 
    ParameterMap::iterator findOrCreateParameter(const std::string& name, UniformType type);
+   void compileParameters();
+
+   static int findConstant(const std::string& name);
+   bool setConstant(int index, UniformType type, const void* value);
+   void bindConstants() const;
 
    ParameterMap parameters;
+   std::vector<const MaterialParameterBase*> enabledParameters; // Flattened so that applying doesn't walk the map
+
+   MaterialConstants constants;
+   mutable UPtr<UniformBufferObject> constantsBuffer; // Created when first needed, never shared between materials
+   mutable bool constantsDirty = true;
+
    std::array<bool, 3> commonMaterialParameterUsage = {};
    BlendMode blendMode = BlendMode::Opaque;
 };
@@ -18,7 +18,7 @@ void uniform_type##MaterialParameter::apply(DrawingContext& context) const\
 \
    if (enabled)\
    {\
-      context.program->setUniformValue(name, value, false);\
+      context.program->setUniformValue(handle, value, false);\
    }\
 }\
 
@@ -37,6 +37,6 @@ void TextureMaterialParameter::apply(DrawingContext& context) const
    if (enabled && value)
    {
       GLint textureUnit = value->activateAndBind(context);
-      context.program->setUniformValue(name, textureUnit, false);
+      context.program->setUniformValue(handle, textureUnit, false);
    }
 }
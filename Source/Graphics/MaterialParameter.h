@@ -2,6 +2,7 @@
 
 #include "Core/Assert.h"
 #include "Core/Pointers.h"
+#include "Graphics/UniformHandle.h"
 
 #include <glm/glm.hpp>
 
@@ -16,6 +17,7 @@ class MaterialParameterBase
 public:
    MaterialParameterBase(const std::string& paramName)
       : name(paramName)
+      , handle(paramName)
       , enabled(true)
    {
    }
@@ -50,6 +52,7 @@ protected:
    virtual const char* getDataTypeName() const = 0;
 
    const std::string name;
+   const UniformHandle handle;
    bool enabled;
 
 private:
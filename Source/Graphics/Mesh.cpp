@@ -3,8 +3,10 @@
 #include "Core/Assert.h"
 #include "Graphics/DrawingContext.h"
 #include "Graphics/GraphicsContext.h"
+#include "Graphics/InstanceBuffer.h"
 #include "Graphics/ShaderProgram.h"
 
+#include <cstdint>
 #include <utility>
 
 MeshSection::MeshSection()
@@ -55,6 +57,10 @@ void MeshSection::move(MeshSection&& other)
    bitangentBufferObject = std::move(other.bitangentBufferObject);
    colorBufferObject = std::move(other.colorBufferObject);
 
+   arena = std::move(other.arena);
+   arenaAllocation = other.arenaAllocation;
+   other.arenaAllocation = {};
+
    numIndices = other.numIndices;
    other.numIndices = 0;
 
@@ -66,13 +72,7 @@ void MeshSection::move(MeshSection&& other)
 
 void MeshSection::release()
 {
-   elementBufferObject.release();
-   positionBufferObject.release();
-   normalBufferObject.release();
-   texCoordBufferObject.release();
-   tangentBufferObject.release();
-   bitangentBufferObject.release();
-   colorBufferObject.release();
+   releaseBuffers();
 
    if (id != 0)
    {
@@ -85,7 +85,7 @@ void MeshSection::release()
    numIndices = 0;
 }
 
-void MeshSection::setData(const MeshData& data)
+void MeshSection::setData(const MeshData& data, const SPtr<GeometryArena>& geometryArena)
 {
    ASSERT(data.indices.size() % 3 == 0);
    ASSERT(data.positions.valueSize >= 0 && data.positions.valueSize < 5
@@ -101,28 +101,37 @@ void MeshSection::setData(const MeshData& data)
       && data.bitangents.values.size() == 0 || (data.bitangents.values.size() % data.bitangents.valueSize == 0)
       && data.colors.values.size() == 0 || (data.colors.values.size() % data.colors.valueSize == 0));
 
-   bind();
+   releaseBuffers();
+
+   if (geometryArena && geometryArena->allocate(data, arenaAllocation))
+   {
+      arena = geometryArena;
+   }
+   else
+   {
+      bind();
 
-   elementBufferObject.setData(BufferBindingTarget::ElementArray, data.indices.size_bytes(), data.indices.data(),
-      BufferUsage::StaticDraw);
+      elementBufferObject.setData(BufferBindingTarget::ElementArray, data.indices.size_bytes(), data.indices.data(),
+         BufferUsage::StaticDraw);
 
-   positionBufferObject.setData(data.positions.values.size_bytes(), data.positions.values.data(),
-      BufferUsage::StaticDraw, data.positions.valueSize);
+      positionBufferObject.setData(data.positions.values.size_bytes(), data.positions.values.data(),
+         BufferUsage::StaticDraw, data.positions.valueSize);
 
-   normalBufferObject.setData(data.normals.values.size_bytes(), data.normals.values.data(), BufferUsage::StaticDraw,
-      data.normals.valueSize);
+      normalBufferObject.setData(data.normals.values.size_bytes(), data.normals.values.data(), BufferUsage::StaticDraw,
+         data.normals.valueSize);
 
-   texCoordBufferObject.setData(data.texCoords.values.size_bytes(), data.texCoords.values.data(),
-      BufferUsage::StaticDraw, data.texCoords.valueSize);
+      texCoordBufferObject.setData(data.texCoords.values.size_bytes(), data.texCoords.values.data(),
+         BufferUsage::StaticDraw, data.texCoords.valueSize);
 
-   tangentBufferObject.setData(data.tangents.values.size_bytes(), data.tangents.values.data(), BufferUsage::StaticDraw,
-      data.tangents.valueSize);
+      tangentBufferObject.setData(data.tangents.values.size_bytes(), data.tangents.values.data(), BufferUsage::StaticDraw,
+         data.tangents.valueSize);
 
-   bitangentBufferObject.setData(data.bitangents.values.size_bytes(), data.bitangents.values.data(),
-      BufferUsage::StaticDraw, data.bitangents.valueSize);
+      bitangentBufferObject.setData(data.bitangents.values.size_bytes(), data.bitangents.values.data(),
+         BufferUsage::StaticDraw, data.bitangents.valueSize);
 
-   colorBufferObject.setData(data.colors.values.size_bytes(), data.colors.values.data(), BufferUsage::StaticDraw,
-      data.colors.valueSize);
+      colorBufferObject.setData(data.colors.values.size_bytes(), data.colors.values.data(), BufferUsage::StaticDraw,
+         data.colors.valueSize);
+   }
 
    numIndices = static_cast<GLsizei>(data.indices.size());
 
@@ -145,7 +154,20 @@ void MeshSection::draw(const DrawingContext& context) const
    context.program->commit();
 
    bind();
-   GraphicsContext::current().drawElements(PrimitiveMode::Triangles, numIndices, IndexType::UnsignedInt, nullptr);
+   GraphicsContext::current().drawElements(PrimitiveMode::Triangles, numIndices, IndexType::UnsignedInt, getFirstIndexOffset(), getBaseVertex());
+}
+
+void MeshSection::drawInstanced(const DrawingContext& context, const InstanceBuffer& instanceBuffer, GLsizei firstInstance, GLsizei numInstances) const
+{
+   ASSERT(numIndices > 0);
+   ASSERT(numInstances > 0);
+   ASSERT(context.program);
+
+   context.program->commit();
+
+   bind();
+   instanceBuffer.bindAttributes(firstInstance);
+   GraphicsContext::current().drawElementsInstanced(PrimitiveMode::Triangles, numIndices, IndexType::UnsignedInt, getFirstIndexOffset(), numInstances, getBaseVertex());
 }
 
 void MeshSection::setLabel(std::string newLabel)
@@ -190,9 +212,44 @@ void MeshSection::setLabel(std::string newLabel)
 
 void MeshSection::bind() const
 {
-   ASSERT(id != 0);
+   if (arena)
+   {
+      arena->bind();
+   }
+   else
+   {
+      ASSERT(id != 0);
+
+      GraphicsContext::current().bindVertexArray(id);
+   }
+}
+
+void MeshSection::releaseBuffers()
+{
+   if (arena)
+   {
+      arena->free(arenaAllocation);
+      arena = nullptr;
+      arenaAllocation = {};
+   }
+
+   elementBufferObject.release();
+   positionBufferObject.release();
+   normalBufferObject.release();
+   texCoordBufferObject.release();
+   tangentBufferObject.release();
+   bitangentBufferObject.release();
+   colorBufferObject.release();
+}
+
+const GLvoid* MeshSection::getFirstIndexOffset() const
+{
+   return reinterpret_cast<const GLvoid*>(static_cast<uintptr_t>(arenaAllocation.firstIndex) * sizeof(GLuint));
+}
 
-   GraphicsContext::current().bindVertexArray(id);
+GLint MeshSection::getBaseVertex() const
+{
+   return static_cast<GLint>(arenaAllocation.firstVertex);
 }
 
 Mesh::Mesh(std::vector<MeshSection>&& meshSections)
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "Core/Pointers.h"
 #include "Graphics/BufferObject.h"
+#include "Graphics/GeometryArena.h"
 #include "Graphics/GraphicsResource.h"
 #include "Math/Bounds.h"
 
@@ -10,6 +12,7 @@
 
 #include <vector>
 
+class InstanceBuffer;
 struct DrawingContext;
 
 template<typename T>
@@ -45,18 +48,39 @@ private:
    void release();
 
 public:
-   void setData(const MeshData& data);
+   // If an arena is given (and the data fits in it), the section is stored in the arena instead of its own buffers
+   void setData(const MeshData& data, const SPtr<GeometryArena>& geometryArena = nullptr);
    void draw(const DrawingContext& context) const;
+   void drawInstanced(const DrawingContext& context, const InstanceBuffer& instanceBuffer, GLsizei firstInstance, GLsizei numInstances) const;
 
    const Bounds& getBounds() const
    {
       return bounds;
    }
 
+   // Null if the section owns its own buffers
+   const GeometryArena* getArena() const
+   {
+      return arena.get();
+   }
+
+   const GeometryArena::Allocation& getArenaAllocation() const
+   {
+      return arenaAllocation;
+   }
+
    void setLabel(std::string newLabel);
 
 private:
    void bind() const;
+   void releaseBuffers();
+
+   // Both are zero for sections that own their own buffers
+   const GLvoid* getFirstIndexOffset() const;
+   GLint getBaseVertex() const;
+
+   SPtr<GeometryArena> arena;
+   GeometryArena::Allocation arenaAllocation;
 
    BufferObject elementBufferObject;
    VertexBufferObject positionBufferObject;
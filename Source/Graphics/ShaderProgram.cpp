@@ -182,6 +182,7 @@ namespace
 
 ShaderProgram::ShaderProgram()
    : GraphicsResource(GraphicsResourceType::Program)
+   , uniformBlockBindingMask(0)
    , linked(false)
 {
    id = glCreateProgram();
@@ -208,13 +209,18 @@ ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other)
 void ShaderProgram::move(ShaderProgram&& other)
 {
    uniforms = std::move(other.uniforms);
+   resolvedUniforms = std::move(other.resolvedUniforms);
    shaders = std::move(other.shaders);
 
+   uniformBlockBindingMask = other.uniformBlockBindingMask;
+   other.uniformBlockBindingMask = 0;
+
    linked = other.linked;
    other.linked = false;
 
 #if SWAP_DEBUG
    onLink = std::move(other.onLink);
+   uniformBlockBindings = std::move(other.uniformBlockBindings);
 #endif // SWAP_DEBUG
 
    GraphicsResource::move(std::move(other));
@@ -262,7 +268,10 @@ bool ShaderProgram::link()
    ASSERT(shaders.size() >= 2, "Need at least two shaders to link (currently have %lu)", shaders.size());
 
 #if SWAP_DEBUG
+   // Resolved handles point at the old uniforms, so they need to be resolved again
    uniforms.clear();
+   resolvedUniforms.clear();
+   uniformBlockBindingMask = 0;
 #else // SWAP_DEBUG
    // Don't allow re-linking shader programs in release builds
    if (linked)
@@ -292,9 +301,9 @@ bool ShaderProgram::link()
 #if SWAP_DEBUG
    onLink.broadcast(*this, true);
 
-   for (const SPtr<UniformBufferObject>& uniformBuffer : uniformBuffers)
+   for (const auto& pair : uniformBlockBindings)
    {
-      bindUniformBuffer(uniformBuffer);
+      bindUniformBlock(pair.first, pair.second);
    }
 #endif // SWAP_DEBUG
 
@@ -311,26 +320,57 @@ void ShaderProgram::commit()
    }
 }
 
+Uniform* ShaderProgram::resolveUniform(UniformHandle handle)
+{
+   // Nothing to resolve against yet
+   if (!linked)
+   {
+      return nullptr;
+   }
+
+   if (handle.getIndex() >= resolvedUniforms.size())
+   {
+      resolvedUniforms.resize(handle.getIndex() + 1);
+   }
+
+   ResolvedUniform& resolvedUniform = resolvedUniforms[handle.getIndex()];
+
+   auto location = uniforms.find(handle.getName());
+   resolvedUniform.uniform = location != uniforms.end() ? location->second.get() : nullptr;
+   resolvedUniform.resolved = true;
+
+   return resolvedUniform.uniform;
+}
+
 void ShaderProgram::bindUniformBuffer(const SPtr<UniformBufferObject>& buffer)
 {
    ASSERT(buffer);
    ASSERT(buffer->getBoundIndex() != UniformBufferObjectIndex::Invalid);
 
-   GLuint blockIndex = glGetUniformBlockIndex(id, buffer->getBlockName().c_str());
-   if (blockIndex == GL_INVALID_INDEX)
-   {
-      LOG_WARNING("Uniform block not found: " << buffer->getBlockName());
-      return;
-   }
+   bindUniformBlock(buffer->getBlockName(), buffer->getBoundIndex());
+}
 
-   glUniformBlockBinding(id, blockIndex, static_cast<GLuint>(buffer->getBoundIndex()));
+void ShaderProgram::bindUniformBlock(const std::string& blockName, UniformBufferObjectIndex index)
+{
+   ASSERT(index != UniformBufferObjectIndex::Invalid && static_cast<GLuint>(index) < 32);
 
 #if SWAP_DEBUG
-   if (std::find(uniformBuffers.begin(), uniformBuffers.end(), buffer) == uniformBuffers.end())
+   std::pair<std::string, UniformBufferObjectIndex> binding(blockName, index);
+   if (std::find(uniformBlockBindings.begin(), uniformBlockBindings.end(), binding) == uniformBlockBindings.end())
    {
-      uniformBuffers.push_back(buffer);
+      uniformBlockBindings.push_back(std::move(binding));
    }
 #endif // SWAP_DEBUG
+
+   GLuint blockIndex = glGetUniformBlockIndex(id, blockName.c_str());
+   if (blockIndex == GL_INVALID_INDEX)
+   {
+      LOG_WARNING("Uniform block not found: " << blockName);
+      return;
+   }
+
+   glUniformBlockBinding(id, blockIndex, static_cast<GLuint>(index));
+   uniformBlockBindingMask |= 1u << static_cast<GLuint>(index);
 }
 
 #if SWAP_DEBUG
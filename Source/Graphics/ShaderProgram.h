@@ -7,15 +7,19 @@
 #include "Core/Pointers.h"
 #include "Graphics/GraphicsResource.h"
 #include "Graphics/Uniform.h"
+#include "Graphics/UniformHandle.h"
 
 #include <glad/gl.h>
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 class Shader;
 class UniformBufferObject;
+enum class UniformBufferObjectIndex : GLuint;
 
 class ShaderProgram : public GraphicsResource
 {
@@ -61,8 +65,31 @@ public:
       return false;
    }
 
+   // Prefer this over setting values by name in code that runs every draw
+   template<typename T>
+   bool setUniformValue(UniformHandle handle, const T& value, bool assertOnFailure = true)
+   {
+      if (Uniform* uniform = findUniform(handle))
+      {
+         uniform->setValue(value);
+         return true;
+      }
+
+      ASSERT(!assertOnFailure, "Uniform with given name doesn't exist: %s", handle.getName().c_str());
+      return false;
+   }
+
    void bindUniformBuffer(const SPtr<UniformBufferObject>& buffer);
 
+   // For blocks that don't have a single buffer (like material constants, which every material has its own buffer for),
+   // where whoever fills the block binds their buffer to the index before drawing
+   void bindUniformBlock(const std::string& blockName, UniformBufferObjectIndex index);
+
+   bool hasUniformBlockBinding(UniformBufferObjectIndex index) const
+   {
+      return (uniformBlockBindingMask & (1u << static_cast<GLuint>(index))) != 0;
+   }
+
    const UniformMap& getUniforms() const
    {
       return uniforms;
@@ -88,12 +115,34 @@ public:
 #endif // SWAP_DEBUG
 
 private:
+   struct ResolvedUniform
+   {
+      Uniform* uniform = nullptr; // Null if the program doesn't have the uniform
+      bool resolved = false;
+   };
+
+   Uniform* findUniform(UniformHandle handle)
+   {
+      ASSERT(handle.isValid());
+
+      if (handle.getIndex() < resolvedUniforms.size() && resolvedUniforms[handle.getIndex()].resolved)
+      {
+         return resolvedUniforms[handle.getIndex()].uniform;
+      }
+
+      return resolveUniform(handle);
+   }
+
+   Uniform* resolveUniform(UniformHandle handle);
+
    UniformMap uniforms;
+   std::vector<ResolvedUniform> resolvedUniforms; // Indexed by uniform handle
    std::vector<SPtr<Shader>> shaders;
+   uint32_t uniformBlockBindingMask; // Bit per bound UniformBufferObjectIndex
    bool linked;
 
 #if SWAP_DEBUG
    OnLinkDelegate onLink;
-   std::vector<SPtr<UniformBufferObject>> uniformBuffers;
+   std::vector<std::pair<std::string, UniformBufferObjectIndex>> uniformBlockBindings;
 #endif // SWAP_DEBUG
 };
@@ -28,6 +28,16 @@ void UniformBufferObject::move(UniformBufferObject&& other)
    BufferObject::move(std::move(other));
 }
 
+void UniformBufferObject::setData(const void* data, std::size_t size)
+{
+   BufferObject::setData(BufferBindingTarget::Uniform, static_cast<GLsizeiptr>(size), data, BufferUsage::DynamicDraw);
+}
+
+void UniformBufferObject::updateData(const void* data, std::size_t size)
+{
+   BufferObject::updateData(BufferBindingTarget::Uniform, 0, static_cast<GLsizeiptr>(size), data);
+}
+
 void UniformBufferObject::bindTo(UniformBufferObjectIndex index)
 {
    glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(index), getId());
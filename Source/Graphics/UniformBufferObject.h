@@ -15,6 +15,8 @@ enum class UniformBufferObjectIndex : GLuint
 {
    Framebuffer,
    View,
+   Lights,
+   Material,
 
    Invalid = GL_INVALID_INDEX
 };
@@ -39,6 +41,10 @@ public:
    template<typename... Types>
    void updateData(const std::tuple<Types...>& data);
 
+   // For data that is already laid out to match the block (for blocks with arrays of structs, which tuples can't express)
+   void setData(const void* data, std::size_t size);
+   void updateData(const void* data, std::size_t size);
+
    void bindTo(UniformBufferObjectIndex index);
 
    const std::string& getBlockName() const
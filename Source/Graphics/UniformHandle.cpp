@@ -0,0 +1,52 @@
+#include "Graphics/UniformHandle.h"
+
+#include "Core/Assert.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+   struct UniformNameRegistry
+   {
+      std::mutex mutex;
+      std::unordered_map<std::string, uint32_t> indices;
+      std::deque<std::string> names; // Indexed by handle (a deque, so that references to names stay valid as it grows)
+   };
+
+   // Handles can be created during static initialization, so the registry is created on first use
+   UniformNameRegistry& getRegistry()
+   {
+      static UniformNameRegistry registry;
+      return registry;
+   }
+}
+
+UniformHandle::UniformHandle(const std::string& name)
+{
+   UniformNameRegistry& registry = getRegistry();
+   std::lock_guard<std::mutex> lock(registry.mutex);
+
+   auto location = registry.indices.find(name);
+   if (location != registry.indices.end())
+   {
+      index = location->second;
+   }
+   else
+   {
+      index = static_cast<uint32_t>(registry.names.size());
+      registry.indices.emplace(name, index);
+      registry.names.push_back(name);
+   }
+}
+
+const std::string& UniformHandle::getName() const
+{
+   ASSERT(isValid());
+
+   UniformNameRegistry& registry = getRegistry();
+   std::lock_guard<std::mutex> lock(registry.mutex);
+
+   return registry.names[index];
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Identifies a uniform by name, without needing to hash the name every time a value is set. Names are registered in a
+// single global table, so one handle can be used with every program. Each program resolves a handle to its own uniform
+// the first time it is used with it, and caches the result in an array indexed by the handle. Programs resolve handles
+// again after they are relinked, so handles stay valid across shader reloads.
+class UniformHandle
+{
+public:
+   static const uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+   UniformHandle() = default;
+   explicit UniformHandle(const std::string& name);
+
+   bool isValid() const
+   {
+      return index != kInvalidIndex;
+   }
+
+   uint32_t getIndex() const
+   {
+      return index;
+   }
+
+   const std::string& getName() const;
+
+   bool operator==(const UniformHandle& other) const
+   {
+      return index == other.index;
+   }
+
+   bool operator!=(const UniformHandle& other) const
+   {
+      return !(*this == other);
+   }
+
+private:
+   uint32_t index = kInvalidIndex;
+};
@@ -5,6 +5,7 @@
 #include "Core/Assert.h"
 #include "Core/Log.h"
 #include "Core/Pointers.h"
+#include "Graphics/GeometryArena.h"
 #include "Graphics/GraphicsContext.h"
 #include "Graphics/GraphicsDefines.h"
 #include "Graphics/Model.h"
@@ -175,6 +176,10 @@ namespace
 
    const int kNumSamples = 0;
 
+   // Sections that don't fit keep their own buffers
+   const uint32_t kGeometryArenaVertexCapacity = 1 << 19;
+   const uint32_t kGeometryArenaIndexCapacity = 1 << 21;
+
    UPtr<Window> createWindow()
    {
       glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, SWAP_DESIRED_GL_VERSION_MAJOR);
@@ -465,6 +470,7 @@ int main(int argc, char* argv[])
    if (UPtr<Window> window = createWindow())
    {
       SPtr<ResourceManager> resourceManager = std::make_shared<ResourceManager>();
+      resourceManager->getModelLoader().setGeometryArena(std::make_shared<GeometryArena>(kGeometryArenaVertexCapacity, kGeometryArenaIndexCapacity));
       Scene scene;
 
       auto createSceneRenderer = [&](bool deferred) -> UPtr<SceneRenderer>
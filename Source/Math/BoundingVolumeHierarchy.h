@@ -0,0 +1,562 @@
+#pragma once
+
+#include "Core/Assert.h"
+#include "Math/Bounds.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Dynamic AABB tree, kept balanced with tree rotations as leaves are inserted / removed. Leaves store slightly enlarged
+// ("fat") boxes, so small movements can be absorbed without touching the tree at all.
+template<typename T>
+class BoundingVolumeHierarchy
+{
+public:
+   using NodeId = int32_t;
+   static constexpr NodeId kInvalidNode = -1;
+
+   NodeId insert(const Bounds& bounds, T* data);
+   void remove(NodeId leaf);
+
+   // Returns true if the leaf had to be re-inserted into the tree
+   bool update(NodeId leaf, const Bounds& bounds);
+
+   void clear()
+   {
+      nodes.clear();
+      root = kInvalidNode;
+      freeList = kInvalidNode;
+      numLeaves = 0;
+   }
+
+   T* getData(NodeId leaf) const
+   {
+      ASSERT(leaf >= 0 && leaf < nodes.size() && nodes[leaf].isLeaf());
+
+      return nodes[leaf].data;
+   }
+
+   int getHeight() const
+   {
+      return root == kInvalidNode ? 0 : nodes[root].height;
+   }
+
+   std::size_t getNumLeaves() const
+   {
+      return numLeaves;
+   }
+
+   // overlapFunc(const glm::vec3& min, const glm::vec3& max) -> BoundsOverlap
+   // visitFunc(T* data, bool fullyInside)
+   template<typename OverlapFunc, typename VisitFunc>
+   void query(OverlapFunc&& overlapFunc, VisitFunc&& visitFunc) const;
+
+private:
+   struct Node
+   {
+      glm::vec3 min;
+      glm::vec3 max;
+      T* data = nullptr;
+
+      NodeId parent = kInvalidNode; // Also used as the next node in the free list
+      NodeId child1 = kInvalidNode;
+      NodeId child2 = kInvalidNode;
+
+      // Leaves have a height of 0, free nodes a height of -1
+      int height = -1;
+
+      bool isLeaf() const
+      {
+         return child1 == kInvalidNode;
+      }
+   };
+
+   static float surfaceArea(const glm::vec3& min, const glm::vec3& max)
+   {
+      glm::vec3 size = max - min;
+      return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+   }
+
+   void combine(Node& node, const Node& first, const Node& second)
+   {
+      node.min = glm::min(first.min, second.min);
+      node.max = glm::max(first.max, second.max);
+   }
+
+   NodeId allocateNode();
+   void freeNode(NodeId nodeId);
+
+   void insertLeaf(NodeId leaf);
+   void removeLeaf(NodeId leaf);
+   NodeId balance(NodeId nodeId);
+   void refitAncestors(NodeId nodeId);
+
+   std::vector<Node> nodes;
+   NodeId root = kInvalidNode;
+   NodeId freeList = kInvalidNode;
+   std::size_t numLeaves = 0;
+};
+
+namespace BoundingVolumeHierarchyHelpers
+{
+   // Enlarge leaves by a fraction of their size plus a constant, so that moving / animating objects don't constantly
+   // need to be re-inserted
+   const float kRelativeMargin = 0.1f;
+   const float kAbsoluteMargin = 0.1f;
+
+   inline glm::vec3 getMargin(const Bounds& bounds)
+   {
+      return glm::abs(bounds.extent) * kRelativeMargin + glm::vec3(kAbsoluteMargin);
+   }
+
+   // Small stack for tree traversal that only touches the heap for extremely deep trees
+   template<typename Element>
+   class TraversalStack
+   {
+   public:
+      void push(const Element& element)
+      {
+         if (size < inlineElements.size())
+         {
+            inlineElements[size] = element;
+         }
+         else
+         {
+            overflowElements.push_back(element);
+         }
+
+         ++size;
+      }
+
+      Element pop()
+      {
+         ASSERT(size > 0);
+
+         --size;
+         if (size < inlineElements.size())
+         {
+            return inlineElements[size];
+         }
+
+         Element element = overflowElements.back();
+         overflowElements.pop_back();
+         return element;
+      }
+
+      bool empty() const
+      {
+         return size == 0;
+      }
+
+   private:
+      std::array<Element, 128> inlineElements;
+      std::vector<Element> overflowElements;
+      std::size_t size = 0;
+   };
+}
+
+template<typename T>
+typename BoundingVolumeHierarchy<T>::NodeId BoundingVolumeHierarchy<T>::insert(const Bounds& bounds, T* data)
+{
+   NodeId leaf = allocateNode();
+
+   glm::vec3 margin = BoundingVolumeHierarchyHelpers::getMargin(bounds);
+   Node& node = nodes[leaf];
+   node.min = bounds.getMin() - margin;
+   node.max = bounds.getMax() + margin;
+   node.data = data;
+   node.height = 0;
+
+   insertLeaf(leaf);
+   ++numLeaves;
+
+   return leaf;
+}
+
+template<typename T>
+void BoundingVolumeHierarchy<T>::remove(NodeId leaf)
+{
+   ASSERT(leaf >= 0 && leaf < nodes.size() && nodes[leaf].isLeaf());
+
+   removeLeaf(leaf);
+   freeNode(leaf);
+   --numLeaves;
+}
+
+template<typename T>
+bool BoundingVolumeHierarchy<T>::update(NodeId leaf, const Bounds& bounds)
+{
+   ASSERT(leaf >= 0 && leaf < nodes.size() && nodes[leaf].isLeaf());
+
+   Node& node = nodes[leaf];
+
+   glm::vec3 min = bounds.getMin();
+   glm::vec3 max = bounds.getMax();
+   bool contained = glm::all(glm::lessThanEqual(node.min, min)) && glm::all(glm::greaterThanEqual(node.max, max));
+
+   // Also rebuild if the fat box has become much larger than needed (e.g. after an object shrinks), to keep queries tight
+   glm::vec3 margin = BoundingVolumeHierarchyHelpers::getMargin(bounds);
+   glm::vec3 largeMin = min - margin * 4.0f;
+   glm::vec3 largeMax = max + margin * 4.0f;
+   bool tooLarge = glm::any(glm::lessThan(node.min, largeMin)) || glm::any(glm::greaterThan(node.max, largeMax));
+
+   if (contained && !tooLarge)
+   {
+      return false;
+   }
+
+   removeLeaf(leaf);
+
+   node.min = min - margin;
+   node.max = max + margin;
+
+   insertLeaf(leaf);
+
+   return true;
+}
+
+template<typename T>
+template<typename OverlapFunc, typename VisitFunc>
+void BoundingVolumeHierarchy<T>::query(OverlapFunc&& overlapFunc, VisitFunc&& visitFunc) const
+{
+   if (root == kInvalidNode)
+   {
+      return;
+   }
+
+   // Once a node is completely inside, everything below it is too, so there is no need to test it any further
+   BoundingVolumeHierarchyHelpers::TraversalStack<std::pair<NodeId, bool>> stack;
+   stack.push(std::make_pair(root, false));
+
+   while (!stack.empty())
+   {
+      std::pair<NodeId, bool> entry = stack.pop();
+      const Node& node = nodes[entry.first];
+
+      bool fullyInside = entry.second;
+      if (!fullyInside)
+      {
+         BoundsOverlap overlap = overlapFunc(node.min, node.max);
+         if (overlap == BoundsOverlap::Outside)
+         {
+            continue;
+         }
+
+         fullyInside = overlap == BoundsOverlap::Inside;
+      }
+
+      if (node.isLeaf())
+      {
+         visitFunc(node.data, fullyInside);
+      }
+      else
+      {
+         stack.push(std::make_pair(node.child1, fullyInside));
+         stack.push(std::make_pair(node.child2, fullyInside));
+      }
+   }
+}
+
+template<typename T>
+typename BoundingVolumeHierarchy<T>::NodeId BoundingVolumeHierarchy<T>::allocateNode()
+{
+   NodeId nodeId = freeList;
+   if (nodeId == kInvalidNode)
+   {
+      nodeId = static_cast<NodeId>(nodes.size());
+      nodes.emplace_back();
+   }
+   else
+   {
+      freeList = nodes[nodeId].parent;
+   }
+
+   nodes[nodeId] = Node();
+   nodes[nodeId].height = 0;
+
+   return nodeId;
+}
+
+template<typename T>
+void BoundingVolumeHierarchy<T>::freeNode(NodeId nodeId)
+{
+   ASSERT(nodeId >= 0 && nodeId < nodes.size());
+
+   nodes[nodeId] = Node();
+   nodes[nodeId].parent = freeList;
+   freeList = nodeId;
+}
+
+template<typename T>
+void BoundingVolumeHierarchy<T>::insertLeaf(NodeId leaf)
+{
+   if (root == kInvalidNode)
+   {
+      root = leaf;
+      nodes[root].parent = kInvalidNode;
+      return;
+   }
+
+   // Find the best sibling for the leaf, using the surface area heuristic
+   glm::vec3 leafMin = nodes[leaf].min;
+   glm::vec3 leafMax = nodes[leaf].max;
+
+   NodeId index = root;
+   while (!nodes[index].isLeaf())
+   {
+      const Node& node = nodes[index];
+
+      float area = surfaceArea(node.min, node.max);
+      float combinedArea = surfaceArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+      // Cost of creating a new parent for this node and the new leaf
+      float cost = 2.0f * combinedArea;
+
+      // Minimum cost of pushing the leaf further down the tree
+      float inheritanceCost = 2.0f * (combinedArea - area);
+
+      auto descendCost = [&](NodeId childId)
+      {
+         const Node& child = nodes[childId];
+         float newArea = surfaceArea(glm::min(child.min, leafMin), glm::max(child.max, leafMax));
+
+         return (child.isLeaf() ? newArea : newArea - surfaceArea(child.min, child.max)) + inheritanceCost;
+      };
+
+      float cost1 = descendCost(node.child1);
+      float cost2 = descendCost(node.child2);
+
+      if (cost < cost1 && cost < cost2)
+      {
+         break;
+      }
+
+      index = cost1 < cost2 ? node.child1 : node.child2;
+   }
+
+   NodeId sibling = index;
+
+   // Create a new parent for the leaf and its sibling
+   NodeId oldParent = nodes[sibling].parent;
+   NodeId newParent = allocateNode();
+
+   nodes[newParent].parent = oldParent;
+   combine(nodes[newParent], nodes[leaf], nodes[sibling]);
+   nodes[newParent].height = nodes[sibling].height + 1;
+   nodes[newParent].child1 = sibling;
+   nodes[newParent].child2 = leaf;
+   nodes[sibling].parent = newParent;
+   nodes[leaf].parent = newParent;
+
+   if (oldParent != kInvalidNode)
+   {
+      if (nodes[oldParent].child1 == sibling)
+      {
+         nodes[oldParent].child1 = newParent;
+      }
+      else
+      {
+         nodes[oldParent].child2 = newParent;
+      }
+   }
+   else
+   {
+      root = newParent;
+   }
+
+   refitAncestors(nodes[leaf].parent);
+}
+
+template<typename T>
+void BoundingVolumeHierarchy<T>::removeLeaf(NodeId leaf)
+{
+   if (leaf == root)
+   {
+      root = kInvalidNode;
+      return;
+   }
+
+   NodeId parent = nodes[leaf].parent;
+   NodeId grandParent = nodes[parent].parent;
+   NodeId sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+   if (grandParent != kInvalidNode)
+   {
+      // Destroy the parent and connect the sibling to the grandparent
+      if (nodes[grandParent].child1 == parent)
+      {
+         nodes[grandParent].child1 = sibling;
+      }
+      else
+      {
+         nodes[grandParent].child2 = sibling;
+      }
+      nodes[sibling].parent = grandParent;
+      freeNode(parent);
+
+      refitAncestors(grandParent);
+   }
+   else
+   {
+      root = sibling;
+      nodes[sibling].parent = kInvalidNode;
+      freeNode(parent);
+   }
+
+   nodes[leaf].parent = kInvalidNode;
+}
+
+template<typename T>
+void BoundingVolumeHierarchy<T>::refitAncestors(NodeId nodeId)
+{
+   NodeId index = nodeId;
+   while (index != kInvalidNode)
+   {
+      index = balance(index);
+
+      Node& node = nodes[index];
+      const Node& child1 = nodes[node.child1];
+      const Node& child2 = nodes[node.child2];
+
+      node.height = 1 + glm::max(child1.height, child2.height);
+      combine(node, child1, child2);
+
+      index = node.parent;
+   }
+}
+
+// Performs a left or right rotation if the node is imbalanced, returning the new root of the subtree
+template<typename T>
+typename BoundingVolumeHierarchy<T>::NodeId BoundingVolumeHierarchy<T>::balance(NodeId iA)
+{
+   Node& a = nodes[iA];
+   if (a.isLeaf() || a.height < 2)
+   {
+      return iA;
+   }
+
+   NodeId iB = a.child1;
+   NodeId iC = a.child2;
+   Node& b = nodes[iB];
+   Node& c = nodes[iC];
+
+   int balanceFactor = c.height - b.height;
+
+   // Rotate C up
+   if (balanceFactor > 1)
+   {
+      NodeId iF = c.child1;
+      NodeId iG = c.child2;
+      Node& f = nodes[iF];
+      Node& g = nodes[iG];
+
+      // Swap A and C
+      c.child1 = iA;
+      c.parent = a.parent;
+      a.parent = iC;
+
+      // A's old parent should point to C
+      if (c.parent != kInvalidNode)
+      {
+         if (nodes[c.parent].child1 == iA)
+         {
+            nodes[c.parent].child1 = iC;
+         }
+         else
+         {
+            nodes[c.parent].child2 = iC;
+         }
+      }
+      else
+      {
+         root = iC;
+      }
+
+      if (f.height > g.height)
+      {
+         c.child2 = iF;
+         a.child2 = iG;
+         g.parent = iA;
+         combine(a, b, g);
+         combine(c, a, f);
+
+         a.height = 1 + glm::max(b.height, g.height);
+         c.height = 1 + glm::max(a.height, f.height);
+      }
+      else
+      {
+         c.child2 = iG;
+         a.child2 = iF;
+         f.parent = iA;
+         combine(a, b, f);
+         combine(c, a, g);
+
+         a.height = 1 + glm::max(b.height, f.height);
+         c.height = 1 + glm::max(a.height, g.height);
+      }
+
+      return iC;
+   }
+
+   // Rotate B up
+   if (balanceFactor < -1)
+   {
+      NodeId iD = b.child1;
+      NodeId iE = b.child2;
+      Node& d = nodes[iD];
+      Node& e = nodes[iE];
+
+      // Swap A and B
+      b.child1 = iA;
+      b.parent = a.parent;
+      a.parent = iB;
+
+      // A's old parent should point to B
+      if (b.parent != kInvalidNode)
+      {
+         if (nodes[b.parent].child1 == iA)
+         {
+            nodes[b.parent].child1 = iB;
+         }
+         else
+         {
+            nodes[b.parent].child2 = iB;
+         }
+      }
+      else
+      {
+         root = iB;
+      }
+
+      if (d.height > e.height)
+      {
+         b.child2 = iD;
+         a.child1 = iE;
+         e.parent = iA;
+         combine(a, c, e);
+         combine(b, a, d);
+
+         a.height = 1 + glm::max(c.height, e.height);
+         b.height = 1 + glm::max(a.height, d.height);
+      }
+      else
+      {
+         b.child2 = iE;
+         a.child1 = iD;
+         d.parent = iA;
+         combine(a, c, d);
+         combine(b, a, e);
+
+         a.height = 1 + glm::max(c.height, d.height);
+         b.height = 1 + glm::max(a.height, e.height);
+      }
+
+      return iB;
+   }
+
+   return iA;
+}
@@ -3,6 +3,15 @@
 #include <glm/glm.hpp>
 #include <gsl/span>
 
+#include <cstdint>
+
+enum class BoundsOverlap : uint8_t
+{
+   Outside,
+   Intersecting,
+   Inside
+};
+
 struct Bounds
 {
    static Bounds fromPoints(gsl::span<glm::vec3> points);
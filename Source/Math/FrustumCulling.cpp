@@ -0,0 +1,288 @@
+#include "Math/FrustumCulling.h"
+
+#include "Core/Assert.h"
+
+#include <glm/gtx/norm.hpp>
+
+#if defined(__AVX__)
+#  define SWAP_CULL_AVX 1
+#  include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SWAP_CULL_SSE 1
+#  include <emmintrin.h>
+#endif
+
+namespace
+{
+   float signedPlaneDist(const glm::vec3& point, const glm::vec4& plane)
+   {
+      return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+   }
+
+   float projectedExtent(const glm::vec3& extent, const glm::vec4& plane)
+   {
+      return glm::abs(plane.x) * extent.x + glm::abs(plane.y) * extent.y + glm::abs(plane.z) * extent.z;
+   }
+
+   bool testBounds(float centerX, float centerY, float centerZ, float extentX, float extentY, float extentZ, float radius, const FrustumPlanes& planes)
+   {
+      glm::vec3 center(centerX, centerY, centerZ);
+      glm::vec3 extent(extentX, extentY, extentZ);
+
+      for (const glm::vec4& plane : planes)
+      {
+         // The box is outside if its "most inside" corner is outside, and the sphere is outside if its center is further out than its radius
+         float limit = glm::min(radius, projectedExtent(extent, plane));
+         if (signedPlaneDist(center, plane) < -limit)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+#if SWAP_CULL_AVX
+   const std::size_t kBatchSize = 8;
+
+   std::size_t cullBatches(const PackedBounds& bounds, const FrustumPlanes& planes, std::vector<uint64_t>& visibilityMask)
+   {
+      __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+      __m256 absPlaneX[6], absPlaneY[6], absPlaneZ[6];
+      for (std::size_t p = 0; p < planes.size(); ++p)
+      {
+         planeX[p] = _mm256_set1_ps(planes[p].x);
+         planeY[p] = _mm256_set1_ps(planes[p].y);
+         planeZ[p] = _mm256_set1_ps(planes[p].z);
+         planeW[p] = _mm256_set1_ps(planes[p].w);
+         absPlaneX[p] = _mm256_set1_ps(glm::abs(planes[p].x));
+         absPlaneY[p] = _mm256_set1_ps(glm::abs(planes[p].y));
+         absPlaneZ[p] = _mm256_set1_ps(glm::abs(planes[p].z));
+      }
+
+      const __m256 zero = _mm256_setzero_ps();
+
+      std::size_t i = 0;
+      for (; i + kBatchSize <= bounds.size(); i += kBatchSize)
+      {
+         __m256 centerX = _mm256_loadu_ps(&bounds.centerX[i]);
+         __m256 centerY = _mm256_loadu_ps(&bounds.centerY[i]);
+         __m256 centerZ = _mm256_loadu_ps(&bounds.centerZ[i]);
+         __m256 extentX = _mm256_loadu_ps(&bounds.extentX[i]);
+         __m256 extentY = _mm256_loadu_ps(&bounds.extentY[i]);
+         __m256 extentZ = _mm256_loadu_ps(&bounds.extentZ[i]);
+         __m256 radius = _mm256_loadu_ps(&bounds.radius[i]);
+
+         __m256 outside = zero;
+         for (std::size_t p = 0; p < planes.size(); ++p)
+         {
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(centerX, planeX[p]), _mm256_mul_ps(centerY, planeY[p])), _mm256_add_ps(_mm256_mul_ps(centerZ, planeZ[p]), planeW[p]));
+            __m256 extent = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extentX, absPlaneX[p]), _mm256_mul_ps(extentY, absPlaneY[p])), _mm256_mul_ps(extentZ, absPlaneZ[p]));
+            __m256 limit = _mm256_min_ps(radius, extent);
+
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, _mm256_sub_ps(zero, limit), _CMP_LT_OQ));
+         }
+
+         uint64_t visibleBits = static_cast<uint64_t>(~_mm256_movemask_ps(outside) & 0xFF);
+         visibilityMask[i / 64] |= visibleBits << (i % 64);
+      }
+
+      return i;
+   }
+#elif SWAP_CULL_SSE
+   const std::size_t kBatchSize = 4;
+
+   std::size_t cullBatches(const PackedBounds& bounds, const FrustumPlanes& planes, std::vector<uint64_t>& visibilityMask)
+   {
+      __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+      __m128 absPlaneX[6], absPlaneY[6], absPlaneZ[6];
+      for (std::size_t p = 0; p < planes.size(); ++p)
+      {
+         planeX[p] = _mm_set1_ps(planes[p].x);
+         planeY[p] = _mm_set1_ps(planes[p].y);
+         planeZ[p] = _mm_set1_ps(planes[p].z);
+         planeW[p] = _mm_set1_ps(planes[p].w);
+         absPlaneX[p] = _mm_set1_ps(glm::abs(planes[p].x));
+         absPlaneY[p] = _mm_set1_ps(glm::abs(planes[p].y));
+         absPlaneZ[p] = _mm_set1_ps(glm::abs(planes[p].z));
+      }
+
+      const __m128 zero = _mm_setzero_ps();
+
+      std::size_t i = 0;
+      for (; i + kBatchSize <= bounds.size(); i += kBatchSize)
+      {
+         __m128 centerX = _mm_loadu_ps(&bounds.centerX[i]);
+         __m128 centerY = _mm_loadu_ps(&bounds.centerY[i]);
+         __m128 centerZ = _mm_loadu_ps(&bounds.centerZ[i]);
+         __m128 extentX = _mm_loadu_ps(&bounds.extentX[i]);
+         __m128 extentY = _mm_loadu_ps(&bounds.extentY[i]);
+         __m128 extentZ = _mm_loadu_ps(&bounds.extentZ[i]);
+         __m128 radius = _mm_loadu_ps(&bounds.radius[i]);
+
+         __m128 outside = zero;
+         for (std::size_t p = 0; p < planes.size(); ++p)
+         {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, planeX[p]), _mm_mul_ps(centerY, planeY[p])), _mm_add_ps(_mm_mul_ps(centerZ, planeZ[p]), planeW[p]));
+            __m128 extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, absPlaneX[p]), _mm_mul_ps(extentY, absPlaneY[p])), _mm_mul_ps(extentZ, absPlaneZ[p]));
+            __m128 limit = _mm_min_ps(radius, extent);
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(zero, limit)));
+         }
+
+         uint64_t visibleBits = static_cast<uint64_t>(~_mm_movemask_ps(outside) & 0xF);
+         visibilityMask[i / 64] |= visibleBits << (i % 64);
+      }
+
+      return i;
+   }
+#else
+   std::size_t cullBatches(const PackedBounds& bounds, const FrustumPlanes& planes, std::vector<uint64_t>& visibilityMask)
+   {
+      return 0;
+   }
+#endif
+}
+
+void PackedBounds::clear()
+{
+   centerX.clear();
+   centerY.clear();
+   centerZ.clear();
+   extentX.clear();
+   extentY.clear();
+   extentZ.clear();
+   radius.clear();
+}
+
+void PackedBounds::reserve(std::size_t capacity)
+{
+   centerX.reserve(capacity);
+   centerY.reserve(capacity);
+   centerZ.reserve(capacity);
+   extentX.reserve(capacity);
+   extentY.reserve(capacity);
+   extentZ.reserve(capacity);
+   radius.reserve(capacity);
+}
+
+void PackedBounds::add(const Bounds& bounds)
+{
+   centerX.push_back(bounds.center.x);
+   centerY.push_back(bounds.center.y);
+   centerZ.push_back(bounds.center.z);
+
+   // The kernel relies on extents being non-negative
+   extentX.push_back(glm::abs(bounds.extent.x));
+   extentY.push_back(glm::abs(bounds.extent.y));
+   extentZ.push_back(glm::abs(bounds.extent.z));
+
+   radius.push_back(bounds.radius);
+}
+
+void PackedBounds::set(std::size_t index, const Bounds& bounds)
+{
+   centerX[index] = bounds.center.x;
+   centerY[index] = bounds.center.y;
+   centerZ[index] = bounds.center.z;
+
+   extentX[index] = glm::abs(bounds.extent.x);
+   extentY[index] = glm::abs(bounds.extent.y);
+   extentZ[index] = glm::abs(bounds.extent.z);
+
+   radius[index] = bounds.radius;
+}
+
+void PackedBounds::removeSwap(std::size_t index)
+{
+   for (std::vector<float>* values : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ, &radius })
+   {
+      (*values)[index] = values->back();
+      values->pop_back();
+   }
+}
+
+namespace FrustumCulling
+{
+   FrustumPlanes computePlanes(const glm::mat4& worldToClip)
+   {
+      FrustumPlanes frustumPlanes;
+
+      for (int i = 0; i < frustumPlanes.size(); ++i)
+      {
+         glm::vec4& frustumPlane = frustumPlanes[i];
+
+         int row = i / 2;
+         int sign = (i % 2) == 0 ? 1 : -1;
+
+         frustumPlane.x = worldToClip[0][3] + sign * worldToClip[0][row];
+         frustumPlane.y = worldToClip[1][3] + sign * worldToClip[1][row];
+         frustumPlane.z = worldToClip[2][3] + sign * worldToClip[2][row];
+         frustumPlane.w = worldToClip[3][3] + sign * worldToClip[3][row];
+
+         frustumPlane /= glm::length(glm::vec3(frustumPlane.x, frustumPlane.y, frustumPlane.z));
+      }
+
+      return frustumPlanes;
+   }
+
+   bool isVisible(const Bounds& bounds, const FrustumPlanes& planes)
+   {
+      glm::vec3 extent = glm::abs(bounds.extent);
+      return testBounds(bounds.center.x, bounds.center.y, bounds.center.z, extent.x, extent.y, extent.z, bounds.radius, planes);
+   }
+
+   BoundsOverlap classifyBox(const glm::vec3& min, const glm::vec3& max, const FrustumPlanes& planes)
+   {
+      glm::vec3 center = (min + max) * 0.5f;
+      glm::vec3 extent = (max - min) * 0.5f;
+
+      bool intersecting = false;
+      for (const glm::vec4& plane : planes)
+      {
+         float dist = signedPlaneDist(center, plane);
+         float planeExtent = projectedExtent(extent, plane);
+
+         if (dist < -planeExtent)
+         {
+            return BoundsOverlap::Outside;
+         }
+
+         intersecting |= dist < planeExtent;
+      }
+
+      return intersecting ? BoundsOverlap::Intersecting : BoundsOverlap::Inside;
+   }
+
+   BoundsOverlap classifyBoxSphere(const glm::vec3& min, const glm::vec3& max, const glm::vec3& sphereCenter, float sphereRadius)
+   {
+      float radiusSquared = sphereRadius * sphereRadius;
+
+      glm::vec3 closestPoint = glm::clamp(sphereCenter, min, max);
+      if (glm::distance2(closestPoint, sphereCenter) > radiusSquared)
+      {
+         return BoundsOverlap::Outside;
+      }
+
+      glm::vec3 farthestPoint = glm::max(glm::abs(min - sphereCenter), glm::abs(max - sphereCenter));
+      return glm::length2(farthestPoint) <= radiusSquared ? BoundsOverlap::Inside : BoundsOverlap::Intersecting;
+   }
+
+   void cullPackedBounds(const PackedBounds& bounds, const FrustumPlanes& planes, std::vector<uint64_t>& visibilityMask)
+   {
+      ASSERT(bounds.centerX.size() == bounds.size() && bounds.centerY.size() == bounds.size() && bounds.centerZ.size() == bounds.size());
+      ASSERT(bounds.extentX.size() == bounds.size() && bounds.extentY.size() == bounds.size() && bounds.extentZ.size() == bounds.size());
+
+      visibilityMask.assign((bounds.size() + 63) / 64, 0);
+
+      // Full batches are handled by the vectorized kernel (if available), and whatever is left over one at a time
+      std::size_t numCulled = cullBatches(bounds, planes, visibilityMask);
+      for (std::size_t i = numCulled; i < bounds.size(); ++i)
+      {
+         if (testBounds(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i], bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i], bounds.radius[i], planes))
+         {
+            visibilityMask[i / 64] |= uint64_t(1) << (i % 64);
+         }
+      }
+   }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Math/Bounds.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using FrustumPlanes = std::array<glm::vec4, 6>;
+
+// World space bounds stored as a structure of arrays, so that the culling kernel can test several of them at once
+struct PackedBounds
+{
+   void clear();
+   void reserve(std::size_t capacity);
+   void add(const Bounds& bounds);
+   void set(std::size_t index, const Bounds& bounds);
+
+   // Moves the last bounds into the given index
+   void removeSwap(std::size_t index);
+
+   std::size_t size() const
+   {
+      return radius.size();
+   }
+
+   std::vector<float> centerX;
+   std::vector<float> centerY;
+   std::vector<float> centerZ;
+   std::vector<float> extentX;
+   std::vector<float> extentY;
+   std::vector<float> extentZ;
+   std::vector<float> radius;
+};
+
+namespace FrustumCulling
+{
+   // Planes point inwards, and are normalized
+   FrustumPlanes computePlanes(const glm::mat4& worldToClip);
+
+   // Bounds are visible unless their sphere or box is completely outside of any of the planes
+   bool isVisible(const Bounds& bounds, const FrustumPlanes& planes);
+
+   BoundsOverlap classifyBox(const glm::vec3& min, const glm::vec3& max, const FrustumPlanes& planes);
+
+   // Classifies the box relative to the sphere (Inside meaning the box is completely contained by the sphere)
+   BoundsOverlap classifyBoxSphere(const glm::vec3& min, const glm::vec3& max, const glm::vec3& sphereCenter, float sphereRadius);
+
+   // Writes one bit per bounds (set if visible), packed into 64 bit words
+   void cullPackedBounds(const PackedBounds& bounds, const FrustumPlanes& planes, std::vector<uint64_t>& visibilityMask);
+
+   inline bool isVisible(const std::vector<uint64_t>& visibilityMask, std::size_t index)
+   {
+      return (visibilityMask[index / 64] & (uint64_t(1) << (index % 64))) != 0;
+   }
+}
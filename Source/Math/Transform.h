@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Math/Bounds.h"
 #include "Math/MathUtils.h"
 
 #include <glm/glm.hpp>
@@ -62,6 +63,20 @@ struct Transform
       return orientation * v;
    }
 
+   // Conservative: the resulting box fully contains the transformed (possibly rotated) local box
+   Bounds transformBounds(const Bounds& localBounds) const
+   {
+      glm::mat3 rotation = glm::toMat3(orientation);
+      glm::vec3 scaledExtent = glm::abs(scale * localBounds.extent);
+
+      Bounds worldBounds;
+      worldBounds.center = transformPosition(localBounds.center);
+      worldBounds.extent = glm::abs(rotation[0]) * scaledExtent.x + glm::abs(rotation[1]) * scaledExtent.y + glm::abs(rotation[2]) * scaledExtent.z;
+      worldBounds.radius = glm::max(glm::max(glm::abs(scale.x), glm::abs(scale.y)), glm::abs(scale.z)) * localBounds.radius;
+
+      return worldBounds;
+   }
+
 private:
    static void multiply(Transform& result, const Transform& first, const Transform& second)
    {
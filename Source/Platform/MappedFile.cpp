@@ -0,0 +1,166 @@
+#include "Platform/MappedFile.h"
+
+#include "Core/Assert.h"
+
+#if SWAP_PLATFORM_MACOS || SWAP_PLATFORM_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // SWAP_PLATFORM_MACOS || SWAP_PLATFORM_LINUX
+
+#if SWAP_PLATFORM_WINDOWS
+#include <Windows.h>
+#endif // SWAP_PLATFORM_WINDOWS
+
+MappedFile::MappedFile(MappedFile&& other)
+{
+   moveFrom(other);
+}
+
+MappedFile::~MappedFile()
+{
+   close();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+   if (this != &other)
+   {
+      close();
+      moveFrom(other);
+   }
+
+   return *this;
+}
+
+#if SWAP_PLATFORM_MACOS || SWAP_PLATFORM_LINUX
+bool MappedFile::open(const std::string& path)
+{
+   ASSERT(!path.empty(), "Trying to map file with empty path");
+
+   close();
+
+   int fileDescriptor = ::open(path.c_str(), O_RDONLY);
+   if (fileDescriptor == -1)
+   {
+      return false;
+   }
+
+   struct stat fileStatus;
+   if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size <= 0)
+   {
+      ::close(fileDescriptor);
+      return false;
+   }
+
+   std::size_t fileSize = static_cast<std::size_t>(fileStatus.st_size);
+   void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+   // The mapping keeps its own reference to the file
+   ::close(fileDescriptor);
+
+   if (mapping == MAP_FAILED)
+   {
+      return false;
+   }
+
+   // Files are generally parsed front to back
+   posix_madvise(mapping, fileSize, POSIX_MADV_SEQUENTIAL);
+
+   data = static_cast<const uint8_t*>(mapping);
+   size = fileSize;
+   return true;
+}
+
+void MappedFile::close()
+{
+   if (data)
+   {
+      munmap(const_cast<uint8_t*>(data), size);
+   }
+
+   data = nullptr;
+   size = 0;
+}
+
+void MappedFile::moveFrom(MappedFile& other)
+{
+   data = other.data;
+   size = other.size;
+
+   other.data = nullptr;
+   other.size = 0;
+}
+#endif // SWAP_PLATFORM_MACOS || SWAP_PLATFORM_LINUX
+
+#if SWAP_PLATFORM_WINDOWS
+bool MappedFile::open(const std::string& path)
+{
+   ASSERT(!path.empty(), "Trying to map file with empty path");
+
+   close();
+
+   HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+   if (file == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   LARGE_INTEGER fileSize;
+   if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+   {
+      CloseHandle(file);
+      return false;
+   }
+
+   HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (!mapping)
+   {
+      CloseHandle(file);
+      return false;
+   }
+
+   void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+   if (!view)
+   {
+      CloseHandle(mapping);
+      CloseHandle(file);
+      return false;
+   }
+
+   data = static_cast<const uint8_t*>(view);
+   size = static_cast<std::size_t>(fileSize.QuadPart);
+   fileHandle = file;
+   mappingHandle = mapping;
+   return true;
+}
+
+void MappedFile::close()
+{
+   if (data)
+   {
+      UnmapViewOfFile(data);
+      CloseHandle(mappingHandle);
+      CloseHandle(fileHandle);
+   }
+
+   data = nullptr;
+   size = 0;
+   fileHandle = nullptr;
+   mappingHandle = nullptr;
+}
+
+void MappedFile::moveFrom(MappedFile& other)
+{
+   data = other.data;
+   size = other.size;
+   fileHandle = other.fileHandle;
+   mappingHandle = other.mappingHandle;
+
+   other.data = nullptr;
+   other.size = 0;
+   other.fileHandle = nullptr;
+   other.mappingHandle = nullptr;
+}
+#endif // SWAP_PLATFORM_WINDOWS
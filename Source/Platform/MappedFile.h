@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read only view of an entire file, mapped into memory. Pages are only read from disk as they are touched, so large files
+// can be parsed in place without first being copied into a buffer.
+class MappedFile
+{
+public:
+   MappedFile() = default;
+   MappedFile(const MappedFile& other) = delete;
+   MappedFile(MappedFile&& other);
+   ~MappedFile();
+
+   MappedFile& operator=(const MappedFile& other) = delete;
+   MappedFile& operator=(MappedFile&& other);
+
+   // Fails for files that don't exist or are empty
+   bool open(const std::string& path);
+   void close();
+
+   bool isOpen() const
+   {
+      return data != nullptr;
+   }
+
+   const uint8_t* getData() const
+   {
+      return data;
+   }
+
+   std::size_t getSize() const
+   {
+      return size;
+   }
+
+private:
+   void moveFrom(MappedFile& other);
+
+   const uint8_t* data = nullptr;
+   std::size_t size = 0;
+
+#if SWAP_PLATFORM_WINDOWS
+   void* fileHandle = nullptr;
+   void* mappingHandle = nullptr;
+#endif // SWAP_PLATFORM_WINDOWS
+};
@@ -87,7 +87,7 @@ namespace
       return material;
    }
 
-   MeshSection processAssimpMesh(const aiMesh& assimpMesh)
+   MeshSection processAssimpMesh(const aiMesh& assimpMesh, const SPtr<GeometryArena>& geometryArena)
    {
       MeshData meshData;
 
@@ -148,29 +148,30 @@ namespace
       }
 
       MeshSection meshSection;
-      meshSection.setData(meshData);
+      meshSection.setData(meshData, geometryArena);
 
       return meshSection;
    }
 
    void processAssimpNode(ModelData& data, const aiScene& assimpScene, const aiNode& assimpNode,
-      const ModelSpecification& specification, const std::string& directory, TextureLoader& textureLoader)
+      const ModelSpecification& specification, const std::string& directory, TextureLoader& textureLoader,
+      const SPtr<GeometryArena>& geometryArena)
    {
       for (unsigned int i = 0; i < assimpNode.mNumMeshes; ++i)
       {
          const aiMesh& assimpMesh = *assimpScene.mMeshes[assimpNode.mMeshes[i]];
 
-         data.meshSections.push_back(processAssimpMesh(assimpMesh));
+         data.meshSections.push_back(processAssimpMesh(assimpMesh, geometryArena));
          data.materials.push_back(processAssimpMaterial(*assimpScene.mMaterials[assimpMesh.mMaterialIndex], specification, directory, textureLoader));
       }
 
       for (unsigned int i = 0; i < assimpNode.mNumChildren; ++i)
       {
-         processAssimpNode(data, assimpScene, *assimpNode.mChildren[i], specification, directory, textureLoader);
+         processAssimpNode(data, assimpScene, *assimpNode.mChildren[i], specification, directory, textureLoader, geometryArena);
       }
    }
 
-   Model loadModelFromFile(const ModelSpecification& specification, TextureLoader& textureLoader)
+   Model loadModelFromFile(const ModelSpecification& specification, TextureLoader& textureLoader, const SPtr<GeometryArena>& geometryArena)
    {
       Model model;
 
@@ -204,7 +205,7 @@ namespace
       }
 
       ModelData data;
-      processAssimpNode(data, *assimpScene, *assimpScene->mRootNode, specification, directory, textureLoader);
+      processAssimpNode(data, *assimpScene, *assimpScene->mRootNode, specification, directory, textureLoader, geometryArena);
 
       ASSERT(data.meshSections.size() == data.materials.size());
 
@@ -255,7 +256,7 @@ Model ModelLoader::loadModel(const ModelSpecification& specification, TextureLoa
       }
    }
 
-   Model model = loadModelFromFile(specification, textureLoader);
+   Model model = loadModelFromFile(specification, textureLoader, geometryArena);
 
    std::string fileName;
    if (OSUtils::getFileNameFromPath(specification.path, fileName, true))
@@ -8,7 +8,9 @@
 #include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
+class GeometryArena;
 class Mesh;
 
 enum class NormalGenerationMode : uint8_t
@@ -61,6 +63,13 @@ public:
 
    void clearCachedData();
 
+   // Mesh sections of models loaded from now on are placed in the arena (when they fit)
+   void setGeometryArena(SPtr<GeometryArena> newGeometryArena)
+   {
+      geometryArena = std::move(newGeometryArena);
+   }
+
 private:
    std::unordered_map<ModelSpecification, ModelRef> modelMap;
+   SPtr<GeometryArena> geometryArena;
 };
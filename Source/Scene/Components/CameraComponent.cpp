@@ -26,17 +26,17 @@ void CameraComponent::makeActiveCamera()
 
 void CameraComponent::moveForward(float amount)
 {
-   relativeTransform.position += getForward() * amount;
+   setRelativePosition(getRelativePosition() + getForward() * amount);
 }
 
 void CameraComponent::moveRight(float amount)
 {
-   relativeTransform.position += getRight() * amount;
+   setRelativePosition(getRelativePosition() + getRight() * amount);
 }
 
 void CameraComponent::moveUp(float amount)
 {
-   relativeTransform.position += getUp() * amount;
+   setRelativePosition(getRelativePosition() + getUp() * amount);
 }
 
 void CameraComponent::rotate(float yaw, float pitch)
@@ -44,7 +44,7 @@ void CameraComponent::rotate(float yaw, float pitch)
    glm::quat yawChange = glm::angleAxis(yaw, MathUtils::kUpVector);
    glm::quat pitchChange = glm::angleAxis(pitch, MathUtils::kRightVector);
 
-   relativeTransform.orientation = glm::normalize(yawChange * relativeTransform.orientation * pitchChange);
+   setRelativeOrientation(glm::normalize(yawChange * getRelativeOrientation() * pitchChange));
 }
 
 glm::vec3 CameraComponent::getForward() const
@@ -4,6 +4,8 @@
 
 class CameraComponent : public SceneComponent
 {
+   SWAP_COMPONENT(CameraComponent, SceneComponent)
+
 protected:
    friend class ComponentRegistrar<CameraComponent>;
 
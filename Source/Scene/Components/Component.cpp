@@ -1,12 +1,95 @@
 #include "Scene/Components/Component.h"
 
+#include "Core/SizeClassAllocator.h"
 #include "Scene/Entity.h"
+#include "Scene/Scene.h"
 
+#include <atomic>
 #include <utility>
 
+namespace
+{
+   // Large enough for hundreds of components of each size class per block
+   const std::size_t kSizeClassBlockSize = 64 * 1024;
+
+   SizeClassAllocator& getSizeClassAllocator()
+   {
+      static SizeClassAllocator allocator(kSizeClassBlockSize);
+      return allocator;
+   }
+
+   std::vector<const PoolAllocator*>& getClassPools()
+   {
+      static std::vector<const PoolAllocator*> classPools;
+      return classPools;
+   }
+}
+
+namespace ComponentTypes
+{
+   ComponentTypeId allocateId()
+   {
+      static std::atomic<std::size_t> nextId = { 0 };
+
+      std::size_t id = nextId++;
+      ASSERT(id < kMaxTypes, "Too many component types, the type mask needs to be widened");
+
+      return static_cast<ComponentTypeId>(id);
+   }
+}
+
+namespace ComponentPools
+{
+   void* allocate(std::size_t size)
+   {
+      return getSizeClassAllocator().allocate(size);
+   }
+
+   void deallocate(void* pointer, std::size_t size)
+   {
+      getSizeClassAllocator().deallocate(pointer, size);
+   }
+
+   bool registerClassPool(const PoolAllocator& pool)
+   {
+      getClassPools().push_back(&pool);
+      return true;
+   }
+
+   std::vector<PoolStats> getStats()
+   {
+      std::vector<PoolStats> stats;
+      getSizeClassAllocator().getStats(stats);
+
+      for (const PoolAllocator* pool : getClassPools())
+      {
+         stats.push_back(pool->getStats());
+      }
+
+      return stats;
+   }
+}
+
+// static
+void* Component::operator new(std::size_t size)
+{
+   return ComponentPools::allocate(size);
+}
+
+// static
+void Component::operator delete(void* pointer, std::size_t size)
+{
+   ComponentPools::deallocate(pointer, size);
+}
+
 Component::~Component()
 {
    onDestroyDelegate.broadcast(this);
+
+   if (tickFunction)
+   {
+      getScene().unregisterTickingComponent(this);
+   }
 }
 
 void Component::destroy()
@@ -35,7 +118,18 @@ void Component::tick(float dt)
 
 void Component::setTickFunction(TickFunction newTickFunction)
 {
+   // Only components with a tick function are in the scene's tick list, so idle components cost nothing per frame
+   bool wasTicking = static_cast<bool>(tickFunction);
    tickFunction = std::move(newTickFunction);
+
+   if (tickFunction && !wasTicking)
+   {
+      getScene().registerTickingComponent(this);
+   }
+   else if (!tickFunction && wasTicking)
+   {
+      getScene().unregisterTickingComponent(this);
+   }
 }
 
 void Component::clearTickFunction()
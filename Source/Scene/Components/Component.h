@@ -3,14 +3,120 @@
 #include "Core/Assert.h"
 #include "Core/Delegate.h"
 #include "Core/Pointers.h"
+#include "Core/PoolAllocator.h"
 
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+class Component;
 class Entity;
 class Scene;
 
+using ComponentTypeId = uint8_t;
+using ComponentTypeMask = uint64_t;
+
+namespace ComponentTypes
+{
+   const std::size_t kMaxTypes = 64;
+
+   // Hands out sequential IDs, the first time each component class is used
+   ComponentTypeId allocateId();
+
+   inline int countBits(ComponentTypeMask mask)
+   {
+#if defined(_MSC_VER)
+      return static_cast<int>(__popcnt64(mask));
+#else
+      return __builtin_popcountll(mask);
+#endif
+   }
+}
+
+// Per class type information. Each component class declares its direct base class with SWAP_COMPONENT(), so that the mask
+// of a class includes the bits of all of its bases (making "is a" tests a single AND).
+template<typename T>
+class ComponentTypeInfo
+{
+public:
+   static ComponentTypeId getId()
+   {
+      static const ComponentTypeId id = ComponentTypes::allocateId();
+      return id;
+   }
+
+   static ComponentTypeMask getMask()
+   {
+      static const ComponentTypeMask mask = calcMask();
+      return mask;
+   }
+
+private:
+   static ComponentTypeMask calcMask()
+   {
+      ComponentTypeMask mask = ComponentTypeMask(1) << getId();
+
+      if constexpr (!std::is_same<T, Component>::value)
+      {
+         // A class without its own declaration would inherit its parent's Super, and silently get the wrong mask
+         static_assert(std::is_same<typename T::ThisComponentClass, T>::value, "Component classes must declare themselves with SWAP_COMPONENT()");
+
+         using Super = typename T::Super;
+         static_assert(std::is_base_of<Super, T>::value && !std::is_same<Super, T>::value, "Component classes must declare their direct base class in SWAP_COMPONENT()");
+
+         mask |= ComponentTypeInfo<Super>::getMask();
+      }
+
+      return mask;
+   }
+};
+
+// Declares the class itself and its direct base class, which ComponentTypeInfo builds the class's type mask from. Every
+// component class (other than Component) needs this.
+#define SWAP_COMPONENT(component_name, super_name) \
+public: \
+   using ThisComponentClass = component_name; \
+   using Super = super_name;
+
+// Groups are ticked in order, each one finishing before the next one starts
+enum class TickGroup : uint8_t
+{
+   Early,
+   Default,
+   Late
+};
+
+struct TickSettings
+{
+   TickGroup group = TickGroup::Default;
+
+   // Thread safe tick functions may run on worker threads (when the scene ticks in parallel), at the same time as other
+   // components in the same group. Tick functions that create or destroy anything must not be marked as thread safe.
+   bool threadSafe = false;
+
+   // Set if the tick function reads the absolute transform of the component or any of its ancestors (including through
+   // the setAbsolute...() functions). Ancestors are then guaranteed to have finished ticking first.
+   bool readsParentTransform = false;
+
+   // Set if the tick function moves the component, which invalidates the transforms of all of its descendants
+   bool writesTransform = false;
+
+   // Minimum time between ticks, in seconds (zero ticks every frame). Tick functions receive the time since they last
+   // ticked, rather than the frame's delta time.
+   float interval = 0.0f;
+
+   // If greater than the interval, the scene's significance function stretches the interval of less significant
+   // components, up to this for completely insignificant ones
+   float maxInterval = 0.0f;
+};
+
 class Component
 {
 public:
@@ -19,6 +125,10 @@ public:
 
    virtual ~Component();
 
+   // Components are allocated from size class pools (see ComponentPools), instead of individually from the heap
+   static void* operator new(std::size_t size);
+   static void operator delete(void* pointer, std::size_t size);
+
    void destroy();
 
    DelegateHandle addOnDestroyDelegate(OnDestroyDelegate::FuncType&& function);
@@ -28,6 +138,16 @@ public:
    void setTickFunction(TickFunction newTickFunction);
    void clearTickFunction();
 
+   const TickSettings& getTickSettings() const
+   {
+      return tickSettings;
+   }
+
+   void setTickSettings(const TickSettings& newTickSettings)
+   {
+      tickSettings = newTickSettings;
+   }
+
    Entity& getEntity()
    {
       return entity;
@@ -41,6 +161,17 @@ public:
    Scene& getScene();
    const Scene& getScene() const;
 
+   ComponentTypeMask getTypeMask() const
+   {
+      return typeMask;
+   }
+
+   template<typename T>
+   bool isA() const
+   {
+      return (typeMask & (ComponentTypeMask(1) << ComponentTypeInfo<T>::getId())) != 0;
+   }
+
 protected:
    Component(Entity& owningEntity)
       : entity(owningEntity)
@@ -57,10 +188,28 @@ protected:
 
 private:
    friend class Entity;
+   friend class Scene;
+   template<typename T> friend class ComponentRegistrar;
 
    Entity& entity;
    OnDestroyDelegate onDestroyDelegate;
    TickFunction tickFunction;
+   TickSettings tickSettings;
+   ComponentTypeMask typeMask = ComponentTypeInfo<Component>::getMask();
+
+   // Position within the scene's list of components of the same type (if it is in one), for constant time removal
+   std::size_t sceneListIndex = static_cast<std::size_t>(-1);
+
+   // Position within the scene's list of components with tick functions (if it has one)
+   std::size_t tickListIndex = static_cast<std::size_t>(-1);
+};
+
+// A registered component class. Resolving a class from its name once (see Entity::findComponentClass()) avoids looking
+// the name up again for every component created from it.
+struct ComponentClass
+{
+   UPtr<Component>(*create)(Entity& entity) = nullptr;
+   ComponentTypeMask typeMask = 0;
 };
 
 template<typename T>
@@ -75,7 +224,10 @@ private:
 
    static UPtr<T> createTypedComponent(Entity& entity)
    {
-      return UPtr<T>(new T(entity));
+      UPtr<T> component(new T(entity));
+      component->typeMask = ComponentTypeInfo<T>::getMask();
+
+      return component;
    }
 
    static UPtr<Component> createComponent(Entity& entity)
@@ -92,6 +244,55 @@ private:
 #  define SWAP_SUPPRESS_UNRECOGNIZED_ATTRIBUTE
 #endif
 
+namespace ComponentPools
+{
+   const std::size_t kSlotsPerBlock = 256;
+
+   // All components share a set of size class pools, so spawning and destroying components recycles slots instead of
+   // going through the heap each time. Only safe to call from the thread that owns the scene.
+   void* allocate(std::size_t size);
+   void deallocate(void* pointer, std::size_t size);
+
+   // Makes a class pool show up in getStats()
+   bool registerClassPool(const PoolAllocator& pool);
+
+   // Occupancy of every size class pool that has been used, followed by that of every class pool
+   std::vector<PoolStats> getStats();
+
+   template<typename T>
+   PoolAllocator& getPool()
+   {
+      static_assert(alignof(T) <= PoolAllocator::kAlignment, "Component class is over-aligned for pooled storage");
+
+      static PoolAllocator pool(sizeof(T), kSlotsPerBlock);
+      static const bool registered = registerClassPool(pool);
+      (void)registered;
+
+      return pool;
+   }
+}
+
+// Gives a component class its own pool, which keeps all components of that class contiguous in memory (in blocks)
+// instead of mixed in with other classes of the same size. Subclasses that are larger than the pooled class fall back to
+// the shared size class pools.
+#define SWAP_POOLED_COMPONENT(component_name) \
+public: \
+   static void* operator new(std::size_t size) \
+   { \
+      return size <= sizeof(component_name) ? ComponentPools::getPool<component_name>().allocate() : ComponentPools::allocate(size); \
+   } \
+   static void operator delete(void* pointer, std::size_t size) \
+   { \
+      if (size <= sizeof(component_name)) \
+      { \
+         ComponentPools::getPool<component_name>().deallocate(pointer); \
+      } \
+      else \
+      { \
+         ComponentPools::deallocate(pointer, size); \
+      } \
+   }
+
 #define SWAP_REFERENCE_COMPONENT(component_name) \
 namespace InitializationHack \
 { \
@@ -121,8 +322,6 @@ private:
    template<typename T> friend class ComponentRegistrar;
    friend class Entity;
 
-   using CreateComponentFunc = UPtr<Component>(*)(Entity&);
-
    static ComponentRegistry& instance();
 
    ComponentRegistry() = default;
@@ -131,9 +330,9 @@ private:
    ComponentRegistry& operator=(const ComponentRegistry& other) = delete;
    ComponentRegistry& operator=(ComponentRegistry&& other) = delete;
 
-   void registerComponent(const std::string& className, CreateComponentFunc createComponentFunc)
+   void registerComponent(const std::string& className, const ComponentClass& componentClass)
    {
-      auto pair = componentMap.emplace(className, createComponentFunc);
+      auto pair = componentMap.emplace(className, componentClass);
       ASSERT(pair.second, "Trying to register a component that has already been registered!");
    }
 
@@ -151,26 +350,48 @@ private:
       return ComponentRegistrar<T>::createTypedComponent(entity);
    }
 
-   UPtr<Component> createComponent(Entity& entity, const std::string& className)
+   const ComponentClass* findComponentClass(const std::string& className) const
    {
       auto location = componentMap.find(className);
-      if (location != componentMap.end())
+      return location != componentMap.end() ? &location->second : nullptr;
+   }
+
+   // Type masks are unique per class, since they include the class's own type bit
+   const std::string* findComponentClassName(ComponentTypeMask typeMask) const
+   {
+      for (const auto& pair : componentMap)
       {
-         CreateComponentFunc& createComponentFunc = location->second;
-         return createComponentFunc(entity);
+         if (pair.second.typeMask == typeMask)
+         {
+            return &pair.first;
+         }
       }
 
       return nullptr;
    }
 
-   std::unordered_map<std::string, CreateComponentFunc> componentMap;
+   UPtr<Component> createComponent(Entity& entity, const std::string& className)
+   {
+      if (const ComponentClass* componentClass = findComponentClass(className))
+      {
+         return componentClass->create(entity);
+      }
+
+      return nullptr;
+   }
+
+   std::unordered_map<std::string, ComponentClass> componentMap;
 };
 
 template<typename T>
 ComponentRegistrar<T>::ComponentRegistrar(const std::string& className)
    : componentClassName(className)
 {
-   ComponentRegistry::instance().registerComponent(componentClassName, &createComponent);
+   ComponentClass componentClass;
+   componentClass.create = &createComponent;
+   componentClass.typeMask = ComponentTypeInfo<T>::getMask();
+
+   ComponentRegistry::instance().registerComponent(componentClassName, componentClass);
 }
 
 template<typename T>
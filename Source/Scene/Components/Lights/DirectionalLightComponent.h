@@ -6,6 +6,9 @@
 
 class DirectionalLightComponent : public LightComponent
 {
+   SWAP_COMPONENT(DirectionalLightComponent, LightComponent)
+   SWAP_POOLED_COMPONENT(DirectionalLightComponent)
+
 protected:
    friend class ComponentRegistrar<DirectionalLightComponent>;
 
@@ -0,0 +1,11 @@
+#include "Scene/Components/Lights/LightComponent.h"
+
+#include "Scene/Scene.h"
+
+void LightComponent::markLightDataDirty()
+{
+   if (!lightDataDirty)
+   {
+      getScene().markLightComponentDirty(this);
+   }
+}
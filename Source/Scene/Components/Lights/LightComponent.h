@@ -6,6 +6,8 @@
 
 class LightComponent : public SceneComponent
 {
+   SWAP_COMPONENT(LightComponent, SceneComponent)
+
 protected:
    LightComponent(Entity& owningEntity)
       : SceneComponent(owningEntity)
@@ -34,6 +36,7 @@ public:
    void setCastShadows(bool newCastShadows)
    {
       castShadows = newCastShadows;
+      markLightDataDirty();
    }
 
    float getShadowBias() const
@@ -46,8 +49,22 @@ public:
       shadowBias = newShadowBias;
    }
 
+protected:
+   void onAbsoluteTransformDirtied() override
+   {
+      markLightDataDirty();
+   }
+
+   // Must be called whenever anything stored in the scene's light data changes (bounds or shadow casting)
+   void markLightDataDirty();
+
 private:
+   friend class Scene;
+
    glm::vec3 color;
    bool castShadows;
    float shadowBias;
+   std::size_t dirtyListIndex = static_cast<std::size_t>(-1); // Index in the scene's list of dirty lights, while dirty
+   bool lightDataDirty = false;
+   int boundingVolumeId = -1;
 };
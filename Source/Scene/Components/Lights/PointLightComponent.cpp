@@ -21,7 +21,7 @@ PointLightComponent::~PointLightComponent()
 
 float PointLightComponent::getScaledRadius() const
 {
-   Transform localToWorld = getAbsoluteTransform();
+   const Transform& localToWorld = getAbsoluteTransform();
    float maxScale = glm::max(glm::max(localToWorld.scale.x, localToWorld.scale.y), localToWorld.scale.z);
 
    return radius * maxScale;
@@ -32,4 +32,5 @@ void PointLightComponent::setRadius(float newRadius)
    ASSERT(newRadius >= 0.0f);
 
    radius = std::max(newRadius, 0.0f);
+   markLightDataDirty();
 }
@@ -4,6 +4,9 @@
 
 class PointLightComponent : public LightComponent
 {
+   SWAP_COMPONENT(PointLightComponent, LightComponent)
+   SWAP_POOLED_COMPONENT(PointLightComponent)
+
 protected:
    friend class ComponentRegistrar<PointLightComponent>;
 
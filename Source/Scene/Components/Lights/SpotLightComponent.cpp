@@ -30,7 +30,7 @@ SpotLightComponent::~SpotLightComponent()
 
 float SpotLightComponent::getScaledRadius() const
 {
-   Transform localToWorld = getAbsoluteTransform();
+   const Transform& localToWorld = getAbsoluteTransform();
 
    return radius * localToWorld.scale.z;
 }
@@ -40,6 +40,7 @@ void SpotLightComponent::setRadius(float newRadius)
    ASSERT(newRadius >= 0.0f);
 
    radius = std::max(newRadius, 0.0f);
+   markLightDataDirty();
 }
 
 void SpotLightComponent::setBeamAngle(float newBeamAngle)
@@ -60,4 +61,5 @@ void SpotLightComponent::setCutoffAngle(float newCutoffAngle)
    cutoffAngle = glm::clamp(glm::max(newCutoffAngle, beamAngle + MathUtils::kKindaSmallNumber),
                             0.0f,
                             kMaxAngle - MathUtils::kKindaSmallNumber);
+   markLightDataDirty();
 }
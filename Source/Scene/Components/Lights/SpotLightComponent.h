@@ -4,6 +4,9 @@
 
 class SpotLightComponent : public LightComponent
 {
+   SWAP_COMPONENT(SpotLightComponent, LightComponent)
+   SWAP_POOLED_COMPONENT(SpotLightComponent)
+
 protected:
    friend class ComponentRegistrar<SpotLightComponent>;
 
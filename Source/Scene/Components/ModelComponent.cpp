@@ -2,6 +2,17 @@
 
 #include "Scene/Scene.h"
 
+#include <array>
+
+namespace
+{
+   // Fraction of a LOD's screen size that has to be crossed before switching to or from it
+   const float kLodHysteresis = 0.1f;
+
+   // Render data is only updated from the thread that owns the scene
+   uint64_t nextRenderDataRevision = 1;
+}
+
 SWAP_REGISTER_COMPONENT(ModelComponent)
 
 ModelComponent::ModelComponent(Entity& owningEntity)
@@ -14,3 +25,94 @@ ModelComponent::~ModelComponent()
 {
    getScene().unregisterModelComponent(this);
 }
+
+void ModelComponent::markBoundingVolumeDirty()
+{
+   if (!boundingVolumeDirty)
+   {
+      getScene().markModelComponentDirty(this);
+   }
+}
+
+void ModelComponent::setLods(std::vector<ModelLod> newLods)
+{
+   for (std::size_t i = 1; i < newLods.size(); ++i)
+   {
+      ASSERT(newLods[i].screenSize <= newLods[i - 1].screenSize, "LODs must be ordered by decreasing screen size");
+   }
+
+   lods = std::move(newLods);
+   lastHysteresisLod = 0;
+   markBoundingVolumeDirty();
+}
+
+std::size_t ModelComponent::selectLod(float screenSize, bool useHysteresis) const
+{
+   std::size_t lod = 0;
+   for (std::size_t i = 0; i < lods.size(); ++i)
+   {
+      std::size_t candidateLod = i + 1;
+      float threshold = lods[i].screenSize;
+
+      // Thresholds that were already crossed to reach the last LOD need to be crossed back by the margin, and vice versa
+      if (useHysteresis)
+      {
+         threshold *= candidateLod <= lastHysteresisLod ? 1.0f + kLodHysteresis : 1.0f - kLodHysteresis;
+      }
+
+      if (screenSize >= threshold)
+      {
+         break;
+      }
+      lod = candidateLod;
+   }
+
+   if (useHysteresis)
+   {
+      lastHysteresisLod = lod;
+   }
+
+   return lod;
+}
+
+void ModelComponent::updateRenderData()
+{
+   const Transform& localToWorld = getAbsoluteTransform();
+
+   localToWorldMatrix = localToWorld.toMatrix();
+   localToNormalMatrix = glm::transpose(glm::inverse(localToWorldMatrix));
+   renderDataRevision = nextRenderDataRevision++;
+
+   worldSectionBounds.clear();
+   lodSectionOffsets.resize(getNumLods() + 1);
+   lodSectionOffsets[0] = 0;
+   for (std::size_t lod = 0; lod < getNumLods(); ++lod)
+   {
+      const Model& lodModel = getLodModel(lod);
+      if (lodModel.getMesh())
+      {
+         for (std::size_t i = 0; i < lodModel.getNumMeshSections(); ++i)
+         {
+            worldSectionBounds.push_back(localToWorld.transformBounds(lodModel.getMeshSection(i).getBounds()));
+         }
+      }
+
+      lodSectionOffsets[lod + 1] = worldSectionBounds.size();
+   }
+
+   if (worldSectionBounds.empty())
+   {
+      worldBounds.center = localToWorld.position;
+      worldBounds.extent = glm::vec3(0.0f);
+      return;
+   }
+
+   std::array<glm::vec3, 2> minMax = { worldSectionBounds[0].getMin(), worldSectionBounds[0].getMax() };
+   for (const Bounds& sectionBounds : worldSectionBounds)
+   {
+      minMax[0] = glm::min(minMax[0], sectionBounds.getMin());
+      minMax[1] = glm::max(minMax[1], sectionBounds.getMax());
+   }
+
+   worldBounds = Bounds::fromPoints(minMax);
+}
@@ -4,9 +4,28 @@
 
 #include "Core/Pointers.h"
 #include "Graphics/Model.h"
+#include "Math/Bounds.h"
+
+#include <glm/glm.hpp>
+#include <gsl/span>
+
+#include <cstdint>
+#include <vector>
+
+struct ModelLod
+{
+   Model model;
+
+   // The LOD is used once the model's screen size (the projected diameter of its bounds, as a fraction of the view's
+   // height) drops below this
+   float screenSize = 0.0f;
+};
 
 class ModelComponent : public SceneComponent
 {
+   SWAP_COMPONENT(ModelComponent, SceneComponent)
+   SWAP_POOLED_COMPONENT(ModelComponent)
+
 protected:
    friend class ComponentRegistrar<ModelComponent>;
 
@@ -23,10 +42,124 @@ public:
    void setModel(Model newModel)
    {
       model = std::move(newModel);
+      markBoundingVolumeDirty();
+   }
+
+   // Lower detail versions of the model, ordered from most to least detailed (with decreasing screen sizes). LOD 0 is
+   // always the model itself.
+   const std::vector<ModelLod>& getLods() const
+   {
+      return lods;
+   }
+
+   void setLods(std::vector<ModelLod> newLods);
+
+   std::size_t getNumLods() const
+   {
+      return lods.size() + 1;
+   }
+
+   const Model& getLodModel(std::size_t lod) const
+   {
+      ASSERT(lod < getNumLods());
+      return lod == 0 ? model : lods[lod - 1].model;
+   }
+
+   // Picks the LOD to use at the given screen size. With hysteresis, the LOD only changes once the screen size crosses a
+   // threshold by some margin, relative to the LOD picked by the last call with hysteresis (so only a single view - the
+   // main one - should use it, from a single thread).
+   std::size_t selectLod(float screenSize, bool useHysteresis) const;
+
+   // World space render data, cached by the scene at the end of each tick in which the model moved or changed. For static
+   // models this is effectively computed once.
+   const glm::mat4& getLocalToWorldMatrix() const
+   {
+      return localToWorldMatrix;
+   }
+
+   const glm::mat4& getLocalToNormalMatrix() const
+   {
+      return localToNormalMatrix;
+   }
+
+   // Union of the world space bounds of all mesh sections (of all LODs)
+   const Bounds& getWorldBounds() const
+   {
+      return worldBounds;
+   }
+
+   gsl::span<const Bounds> getWorldSectionBounds(std::size_t lod = 0) const
+   {
+      ASSERT(lod + 1 < lodSectionOffsets.size());
+      return gsl::span<const Bounds>(worldSectionBounds.data() + lodSectionOffsets[lod], lodSectionOffsets[lod + 1] - lodSectionOffsets[lod]);
+   }
+
+   // Changes every time the cached render data is recomputed, so that renderer caches can tell when it changed. Drawn
+   // from a counter shared by all models, so no two models (even ones that reuse the same memory) ever have the same one.
+   uint64_t getRenderDataRevision() const
+   {
+      return renderDataRevision;
+   }
+
+   // Forces the cached render data to be recomputed (only needed if something it depends on was modified in place, e.g.
+   // a mesh shared with the model)
+   void invalidateRenderData()
+   {
+      markBoundingVolumeDirty();
+   }
+
+   // Beyond this distance (from the view to the closest point of the model's bounding sphere) the model isn't drawn. Zero
+   // means no limit.
+   float getMaxDrawDistance() const
+   {
+      return maxDrawDistance;
+   }
+
+   void setMaxDrawDistance(float newMaxDrawDistance)
+   {
+      ASSERT(newMaxDrawDistance >= 0.0f);
+      maxDrawDistance = newMaxDrawDistance;
+   }
+
+   // Occluders are rasterized into the software occlusion buffer (as their mesh section bounding boxes), so this should
+   // only be enabled for large, solid geometry (walls, floors, buildings) that fills its bounds
+   bool isOccluder() const
+   {
+      return occluder;
+   }
+
+   void setOccluder(bool newOccluder)
+   {
+      occluder = newOccluder;
+   }
+
+protected:
+   void onAbsoluteTransformDirtied() override
+   {
+      markBoundingVolumeDirty();
    }
 
 private:
+   friend class Scene;
+
+   void markBoundingVolumeDirty();
+   void updateRenderData();
+
    Model model;
+   std::vector<ModelLod> lods;
+   mutable std::size_t lastHysteresisLod = 0;
+
+   glm::mat4 localToWorldMatrix = glm::mat4(1.0f);
+   glm::mat4 localToNormalMatrix = glm::mat4(1.0f);
+   Bounds worldBounds;
+   std::vector<Bounds> worldSectionBounds; // Sections of all LODs, back to back
+   std::vector<std::size_t> lodSectionOffsets = { 0, 0 };
+   uint64_t renderDataRevision = 0;
+   float maxDrawDistance = 0.0f;
+   int boundingVolumeId = -1;
+   std::size_t dirtyListIndex = static_cast<std::size_t>(-1); // Index in the scene's list of dirty models, while dirty
+   bool boundingVolumeDirty = false;
+   bool occluder = false;
 };
 
 SWAP_REFERENCE_COMPONENT(ModelComponent)
@@ -1,17 +1,42 @@
 #include "Scene/Components/SceneComponent.h"
 
 #include "Core/Assert.h"
+#include "Scene/Scene.h"
+
+#include <algorithm>
+
+namespace
+{
+   const std::size_t kNotInDirtyTransformList = static_cast<std::size_t>(-1);
+}
 
 SWAP_REGISTER_COMPONENT(SceneComponent)
 
-Transform SceneComponent::getAbsoluteTransform() const
+SceneComponent::SceneComponent(Entity& owningEntity)
+   : Component(owningEntity)
+   , dirtyTransformListIndex(kNotInDirtyTransformList)
+   , absoluteTransformDirty(true)
+   , parent(nullptr)
 {
-   if (!parent)
+   getScene().markTransformDirty(this);
+}
+
+SceneComponent::~SceneComponent()
+{
+   // Hand our children over to our parent (iterate over a copy, since re-parenting modifies the list)
+   std::vector<SceneComponent*> childrenCopy = children;
+   for (SceneComponent* child : childrenCopy)
    {
-      return relativeTransform;
+      child->setParent(parent);
    }
+   ASSERT(children.empty());
+
+   setParent(nullptr);
 
-   return relativeTransform * parent->getAbsoluteTransform();
+   if (dirtyTransformListIndex != kNotInDirtyTransformList)
+   {
+      getScene().unmarkTransformDirty(this);
+   }
 }
 
 void SceneComponent::setAbsoluteTransform(const Transform& newAbsoluteTransform)
@@ -24,6 +49,8 @@ void SceneComponent::setAbsoluteTransform(const Transform& newAbsoluteTransform)
    {
       relativeTransform = newAbsoluteTransform * parent->getAbsoluteTransform().inverse(); // TODO Correct?
    }
+
+   markTransformDirty();
 }
 
 void SceneComponent::setAbsoluteOrientation(const glm::quat& newAbsoluteOrientation)
@@ -60,26 +87,75 @@ void SceneComponent::setParent(SceneComponent* newParent)
       return;
    }
 
-   if (parentDestroyDelegateHandle.isValid())
+   if (parent)
    {
-      ASSERT(parent);
-      parent->removeOnDestroyDelegate(parentDestroyDelegateHandle);
-      parentDestroyDelegateHandle.invalidate();
+      auto location = std::find(parent->children.begin(), parent->children.end(), this);
+      ASSERT(location != parent->children.end());
+      parent->children.erase(location);
    }
 
    if (newParent)
    {
-      parentDestroyDelegateHandle = newParent->addOnDestroyDelegate([this](Component* component)
-      {
-         // Invalidate the handle here to prevent calling removeOnDestroyDelegate() from within setParent()
-         // (Would cause concurrent modification of the multicast delegate)
-         // Safe to do as we know the destroy event will only happen once
-         parentDestroyDelegateHandle.invalidate();
-
-         SceneComponent* sceneComponent = static_cast<SceneComponent*>(component);
-         setParent(sceneComponent->getParent());
-      });
+      ASSERT(std::find(newParent->children.begin(), newParent->children.end(), this) == newParent->children.end());
+      newParent->children.push_back(this);
    }
 
    parent = newParent;
+   markTransformDirty();
+}
+
+void SceneComponent::markTransformDirty()
+{
+   // If this component was already dirty, all of its descendants are too (any clean descendant would have cleaned its
+   // ancestors when it was updated), so there is no need to go any further
+   if (absoluteTransformDirty)
+   {
+      return;
+   }
+
+   // A clean component only has clean ancestors, so nothing else queued so far covers it. It may still be queued itself
+   // though, if it was resolved lazily since it was queued.
+   if (dirtyTransformListIndex == kNotInDirtyTransformList)
+   {
+      getScene().markTransformDirty(this);
+   }
+   propagateTransformDirty();
+}
+
+void SceneComponent::propagateTransformDirty()
+{
+   if (absoluteTransformDirty)
+   {
+      return;
+   }
+
+   absoluteTransformDirty = true;
+   onAbsoluteTransformDirtied();
+
+   for (SceneComponent* child : children)
+   {
+      child->propagateTransformDirty();
+   }
+}
+
+void SceneComponent::updateAbsoluteTransform() const
+{
+   ASSERT(!getScene().areTransformsReadOnly(), "Absolute transforms need to be resolved before they are read from several threads");
+
+   absoluteTransform = parent ? relativeTransform * parent->getAbsoluteTransform() : relativeTransform;
+   absoluteTransformDirty = false;
+}
+
+void SceneComponent::resolveTransforms() const
+{
+   getAbsoluteTransform();
+
+   // Clean children only have clean descendants
+   for (const SceneComponent* child : children)
+   {
+      if (child->absoluteTransformDirty)
+      {
+         child->resolveTransforms();
+      }
+   }
 }
@@ -4,22 +4,33 @@
 
 #include "Math/Transform.h"
 
+#include <cstdint>
+#include <vector>
+
+enum class Mobility : uint8_t
+{
+   // Never moves during gameplay. Derived render data is cached, and is only recomputed when the component is explicitly
+   // moved or changed (which is expected to be rare).
+   Static,
+
+   // Never moves, but other properties (e.g. a light's color or intensity) may change
+   Stationary,
+
+   // May move every frame
+   Movable
+};
+
 class SceneComponent : public Component
 {
+   SWAP_COMPONENT(SceneComponent, Component)
+
 protected:
    friend class ComponentRegistrar<SceneComponent>;
 
-   SceneComponent(Entity& owningEntity)
-      : Component(owningEntity)
-      , parent(nullptr)
-   {
-   }
+   SceneComponent(Entity& owningEntity);
 
 public:
-   Transform& getRelativeTransform()
-   {
-      return relativeTransform;
-   }
+   ~SceneComponent();
 
    const Transform& getRelativeTransform() const
    {
@@ -29,11 +40,7 @@ public:
    void setRelativeTransform(const Transform& newRelativeTransform)
    {
       relativeTransform = newRelativeTransform;
-   }
-
-   glm::quat& getRelativeOrientation()
-   {
-      return relativeTransform.orientation;
+      markTransformDirty();
    }
 
    const glm::quat& getRelativeOrientation() const
@@ -44,11 +51,7 @@ public:
    void setRelativeOrientation(const glm::quat& newRelativeOrientation)
    {
       relativeTransform.orientation = newRelativeOrientation;
-   }
-
-   glm::vec3& getRelativePosition()
-   {
-      return relativeTransform.position;
+      markTransformDirty();
    }
 
    const glm::vec3& getRelativePosition() const
@@ -59,11 +62,7 @@ public:
    void setRelativePosition(const glm::vec3& newRelativePosition)
    {
       relativeTransform.position = newRelativePosition;
-   }
-
-   glm::vec3& getRelativeScale()
-   {
-      return relativeTransform.scale;
+      markTransformDirty();
    }
 
    const glm::vec3& getRelativeScale() const
@@ -74,9 +73,21 @@ public:
    void setRelativeScale(const glm::vec3& newRelativeScale)
    {
       relativeTransform.scale = newRelativeScale;
+      markTransformDirty();
+   }
+
+   // Cached, only recomputed after this component or one of its ancestors has changed. The scene resolves all changed
+   // transforms at the end of each tick and before rendering (see Scene::resolveTransforms()).
+   const Transform& getAbsoluteTransform() const
+   {
+      if (absoluteTransformDirty)
+      {
+         updateAbsoluteTransform();
+      }
+
+      return absoluteTransform;
    }
 
-   Transform getAbsoluteTransform() const;
    void setAbsoluteTransform(const Transform& newAbsoluteTransform);
 
    glm::quat getAbsoluteOrientation() const
@@ -100,6 +111,21 @@ public:
 
    void setAbsoluteScale(const glm::vec3& newAbsoluteScale);
 
+   Mobility getMobility() const
+   {
+      return mobility;
+   }
+
+   void setMobility(Mobility newMobility)
+   {
+      mobility = newMobility;
+   }
+
+   bool isStatic() const
+   {
+      return mobility == Mobility::Static;
+   }
+
    SceneComponent* getParent()
    {
       return parent;
@@ -112,12 +138,35 @@ public:
 
    void setParent(SceneComponent* newParent);
 
+   const std::vector<SceneComponent*>& getChildren() const
+   {
+      return children;
+   }
+
 protected:
-   Transform relativeTransform;
+   // Called whenever the absolute transform is invalidated (by a change to this component or one of its ancestors)
+   virtual void onAbsoluteTransformDirtied()
+   {
+   }
 
 private:
+   friend class Scene;
+
+   void markTransformDirty();
+   void propagateTransformDirty();
+   void updateAbsoluteTransform() const;
+   void resolveTransforms() const;
+
+   // Set while this component is queued in the scene's list of dirty transforms
+   std::size_t dirtyTransformListIndex;
+
+   Transform relativeTransform;
+   mutable Transform absoluteTransform;
+   mutable bool absoluteTransformDirty;
+   Mobility mobility = Mobility::Movable;
+
    SceneComponent* parent;
-   DelegateHandle parentDestroyDelegateHandle;
+   std::vector<SceneComponent*> children;
 };
 
 SWAP_REFERENCE_COMPONENT(SceneComponent)
@@ -4,23 +4,46 @@
 
 #include <algorithm>
 
+namespace
+{
+   const std::size_t kEntitiesPerBlock = 256;
+
+   PoolAllocator& getEntityPool()
+   {
+      static PoolAllocator pool(sizeof(Entity), kEntitiesPerBlock);
+      return pool;
+   }
+}
+
 Entity::~Entity()
 {
    onDestroyDelegate.broadcast(this);
 }
 
-void Entity::destroy()
+// static
+void* Entity::operator new(std::size_t size)
 {
-   bool destroyed = scene.destroyEntity(this);
-   ASSERT(destroyed, "Entity not destroyed by scene, possibly already distroyed?");
+   ASSERT(size == sizeof(Entity));
+   return getEntityPool().allocate();
 }
 
-void Entity::tick(float dt)
+// static
+void Entity::operator delete(void* pointer, std::size_t size)
 {
-   for (const UPtr<Component>& component : components)
-   {
-      component->tick(dt);
-   }
+   ASSERT(size == sizeof(Entity));
+   getEntityPool().deallocate(pointer);
+}
+
+// static
+PoolStats Entity::getPoolStats()
+{
+   return getEntityPool().getStats();
+}
+
+void Entity::destroy()
+{
+   bool destroyed = scene.destroyEntity(this);
+   ASSERT(destroyed, "Entity not destroyed by scene, possibly already distroyed?");
 }
 
 Component* Entity::createComponentByName(const std::string& className)
@@ -32,11 +55,23 @@ Component* Entity::createComponentByName(const std::string& className)
    }
 
    Component* newComponentRaw = newComponent.get();
-   components.push_back(std::move(newComponent));
+   addComponent(std::move(newComponent));
    onComponentCreated(newComponentRaw);
    return newComponentRaw;
 }
 
+// static
+const ComponentClass* Entity::findComponentClass(const std::string& className)
+{
+   return ComponentRegistry::instance().findComponentClass(className);
+}
+
+// static
+const std::string* Entity::findComponentClassName(const Component& component)
+{
+   return ComponentRegistry::instance().findComponentClassName(component.getTypeMask());
+}
+
 bool Entity::destroyComponent(Component* componentToDestroy)
 {
    auto location = std::find_if(components.begin(), components.end(), [componentToDestroy](const UPtr<Component>& component)
@@ -47,6 +82,7 @@ bool Entity::destroyComponent(Component* componentToDestroy)
    if (location != components.end())
    {
       components.erase(location);
+      rebuildComponentTypeIndex();
       return true;
    }
 
@@ -73,7 +109,7 @@ UPtr<Entity> Entity::create(gsl::span<std::string> componentClassNames, Scene& s
    {
       if (UPtr<Component> newComponent = ComponentRegistry::instance().createComponent(*entity, className))
       {
-         entity->components.push_back(std::move(newComponent));
+         entity->addComponent(std::move(newComponent));
       }
    }
    entity->onInitialized();
@@ -81,6 +117,22 @@ UPtr<Entity> Entity::create(gsl::span<std::string> componentClassNames, Scene& s
    return entity;
 }
 
+// static
+UPtr<Entity> Entity::create(gsl::span<const ComponentClass* const> componentClasses, Scene& scene)
+{
+   UPtr<Entity> entity(new Entity(scene));
+
+   entity->components.reserve(componentClasses.size());
+   for (const ComponentClass* componentClass : componentClasses)
+   {
+      ASSERT(componentClass);
+      entity->addComponent(componentClass->create(*entity));
+   }
+   entity->onInitialized();
+
+   return entity;
+}
+
 void Entity::onInitialized()
 {
    for (const UPtr<Component>& component : components)
@@ -96,3 +148,37 @@ void Entity::onComponentCreated(Component* component)
       component->onComponentAddedToOwner(component.get());
    }
 }
+
+void Entity::addComponent(UPtr<Component> component)
+{
+   ASSERT(component);
+
+   indexComponentType(component.get());
+   components.push_back(std::move(component));
+}
+
+void Entity::indexComponentType(Component* component)
+{
+   // Give each type that this component adds to the entity a slot
+   ComponentTypeMask newTypes = component->getTypeMask() & ~componentTypes;
+   while (newTypes != 0)
+   {
+      ComponentTypeMask typeBit = newTypes & (~newTypes + 1);
+      newTypes &= newTypes - 1;
+
+      componentTypes |= typeBit;
+      std::size_t slot = ComponentTypes::countBits(componentTypes & (typeBit - 1));
+      firstComponentOfType.insert(firstComponentOfType.begin() + slot, component);
+   }
+}
+
+void Entity::rebuildComponentTypeIndex()
+{
+   componentTypes = 0;
+   firstComponentOfType.clear();
+
+   for (const UPtr<Component>& component : components)
+   {
+      indexComponentType(component.get());
+   }
+}
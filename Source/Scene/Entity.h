@@ -7,12 +7,118 @@
 
 #include <gsl/span>
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
 
 class Scene;
 
+// Weak reference to an entity. Unlike a pointer, a handle can be safely resolved (through the scene) after the entity
+// has been destroyed, since slots are reused with a new generation.
+struct EntityHandle
+{
+   static const uint32_t kInvalidIndex = 0xFFFFFFFF;
+
+   uint32_t index = kInvalidIndex;
+   uint32_t generation = 0;
+
+   bool isNull() const
+   {
+      return index == kInvalidIndex;
+   }
+
+   bool operator==(const EntityHandle& other) const
+   {
+      return index == other.index && generation == other.generation;
+   }
+
+   bool operator!=(const EntityHandle& other) const
+   {
+      return !(*this == other);
+   }
+};
+
+// Iterates over the components of an entity that are of (or derive from) a given class, without allocating
+template<typename T>
+class ComponentClassRange
+{
+public:
+   class Iterator
+   {
+   public:
+      Iterator(const UPtr<Component>* inCurrent, const UPtr<Component>* inEnd, ComponentTypeMask inTypeBit)
+         : current(inCurrent)
+         , end(inEnd)
+         , typeBit(inTypeBit)
+      {
+         skipNonMatching();
+      }
+
+      T* operator*() const
+      {
+         return static_cast<T*>(current->get());
+      }
+
+      Iterator& operator++()
+      {
+         ++current;
+         skipNonMatching();
+         return *this;
+      }
+
+      bool operator==(const Iterator& other) const
+      {
+         return current == other.current;
+      }
+
+      bool operator!=(const Iterator& other) const
+      {
+         return current != other.current;
+      }
+
+   private:
+      void skipNonMatching()
+      {
+         while (current != end && ((*current)->getTypeMask() & typeBit) == 0)
+         {
+            ++current;
+         }
+      }
+
+      const UPtr<Component>* current;
+      const UPtr<Component>* end;
+      ComponentTypeMask typeBit;
+   };
+
+   ComponentClassRange(const std::vector<UPtr<Component>>& components, ComponentTypeMask inTypeBit)
+      : first(components.data())
+      , last(components.data() + components.size())
+      , typeBit(inTypeBit)
+   {
+   }
+
+   Iterator begin() const
+   {
+      return Iterator(first, last, typeBit);
+   }
+
+   Iterator end() const
+   {
+      return Iterator(last, last, typeBit);
+   }
+
+   bool empty() const
+   {
+      return begin() == end();
+   }
+
+private:
+   const UPtr<Component>* first;
+   const UPtr<Component>* last;
+   ComponentTypeMask typeBit;
+};
+
 class Entity
 {
 public:
@@ -20,14 +126,24 @@ public:
 
    ~Entity();
 
-   void destroy();
+   // Entities are allocated from a pool, instead of individually from the heap
+   static void* operator new(std::size_t size);
+   static void operator delete(void* pointer, std::size_t size);
+
+   static PoolStats getPoolStats();
 
-   void tick(float dt);
+   void destroy();
 
    template<typename T>
    T* createComponent();
 
    Component* createComponentByName(const std::string& className);
+
+   // Returns null if no component class with the given name has been registered
+   static const ComponentClass* findComponentClass(const std::string& className);
+
+   // Returns null if the component's class hasn't been registered
+   static const std::string* findComponentClassName(const Component& component);
    bool destroyComponent(Component* componentToDestroy);
 
    template<typename T>
@@ -37,10 +153,10 @@ public:
    const T* getComponentByClass() const;
 
    template<typename T>
-   std::vector<T*> getComponentsByClass();
+   ComponentClassRange<T> getComponentsByClass();
 
    template<typename T>
-   std::vector<const T*> getComponentsByClass() const;
+   ComponentClassRange<const T> getComponentsByClass() const;
 
    DelegateHandle addOnDestroyDelegate(OnDestroyDelegate::FuncType&& function);
    void removeOnDestroyDelegate(const DelegateHandle& handle);
@@ -55,6 +171,16 @@ public:
       return scene;
    }
 
+   EntityHandle getHandle() const
+   {
+      return handle;
+   }
+
+   bool isPendingDestruction() const
+   {
+      return pendingDestruction;
+   }
+
 private:
    friend class Scene;
 
@@ -62,6 +188,7 @@ private:
    static UPtr<Entity> create(Scene& scene);
 
    static UPtr<Entity> create(gsl::span<std::string> componentClassNames, Scene& scene);
+   static UPtr<Entity> create(gsl::span<const ComponentClass* const> componentClasses, Scene& scene);
 
    Entity(Scene& owningScene)
       : scene(owningScene)
@@ -77,9 +204,34 @@ private:
    void onInitialized();
    void onComponentCreated(Component* component);
 
+   void addComponent(UPtr<Component> component);
+   void indexComponentType(Component* component);
+   void rebuildComponentTypeIndex();
+
+   Component* findFirstComponentOfType(ComponentTypeId typeId) const
+   {
+      ComponentTypeMask typeBit = ComponentTypeMask(1) << typeId;
+      if ((componentTypes & typeBit) == 0)
+      {
+         return nullptr;
+      }
+
+      // Slots are stored in bit order, so the slot index is the number of lower types present
+      return firstComponentOfType[ComponentTypes::countBits(componentTypes & (typeBit - 1))];
+   }
+
    std::vector<UPtr<Component>> components;
    OnDestroyDelegate onDestroyDelegate;
    Scene& scene;
+
+   // Managed by the scene
+   EntityHandle handle;
+   std::size_t sceneIndex = 0;
+   bool pendingDestruction = false;
+
+   // Union of the type masks of all components, and the first component of each type that is present
+   ComponentTypeMask componentTypes = 0;
+   std::vector<Component*> firstComponentOfType;
 };
 
 template<typename T>
@@ -89,7 +241,7 @@ T* Entity::createComponent()
    ASSERT(newComponent, "Failed to create a typed component");
 
    T* newComponentRaw = newComponent.get();
-   components.push_back(std::move(newComponent));
+   addComponent(std::move(newComponent));
    onComponentCreated(newComponentRaw);
    return newComponentRaw;
 }
@@ -97,61 +249,25 @@ T* Entity::createComponent()
 template<typename T>
 T* Entity::getComponentByClass()
 {
-   for (const UPtr<Component>& component : components)
-   {
-      if (T* castedComponent = dynamic_cast<T*>(component.get()))
-      {
-         return castedComponent;
-      }
-   }
-
-   return nullptr;
+   return static_cast<T*>(findFirstComponentOfType(ComponentTypeInfo<T>::getId()));
 }
 
 template<typename T>
 const T* Entity::getComponentByClass() const
 {
-   for (const UPtr<Component>& component : components)
-   {
-      if (const T* castedComponent = dynamic_cast<const T*>(component.get()))
-      {
-         return castedComponent;
-      }
-   }
-
-   return nullptr;
+   return static_cast<const T*>(findFirstComponentOfType(ComponentTypeInfo<T>::getId()));
 }
 
 template<typename T>
-std::vector<T*> Entity::getComponentsByClass()
+ComponentClassRange<T> Entity::getComponentsByClass()
 {
-   std::vector<T*> componentsOfClass;
-
-   for (const UPtr<Component>& component : components)
-   {
-      if (T* castedComponent = dynamic_cast<T*>(component.get()))
-      {
-         componentsOfClass.push_back(castedComponent);
-      }
-   }
-
-   return componentsOfClass;
+   return ComponentClassRange<T>(components, ComponentTypeMask(1) << ComponentTypeInfo<T>::getId());
 }
 
 template<typename T>
-std::vector<const T*> Entity::getComponentsByClass() const
+ComponentClassRange<const T> Entity::getComponentsByClass() const
 {
-   std::vector<const T*> componentsOfClass;
-
-   for (const UPtr<Component>& component : components)
-   {
-      if (const T* castedComponent = dynamic_cast<const T*>(component.get()))
-      {
-         componentsOfClass.push_back(castedComponent);
-      }
-   }
-
-   return componentsOfClass;
+   return ComponentClassRange<const T>(components, ComponentTypeMask(1) << ComponentTypeInfo<T>::getId());
 }
 
 // static
@@ -169,7 +285,7 @@ UPtr<Entity> Entity::create(Scene& scene)
 template<typename First, typename... Rest>
 void Entity::constructComponentsHelper()
 {
-   components.push_back(ComponentRegistry::instance().createComponent<First>(*this));
+   addComponent(ComponentRegistry::instance().createComponent<First>(*this));
    constructComponents<Rest...>();
 }
 
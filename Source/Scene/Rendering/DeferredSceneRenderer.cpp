@@ -6,6 +6,7 @@
 #include "Graphics/Material.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Texture.h"
+#include "Graphics/UniformHandle.h"
 #include "Platform/IOUtils.h"
 #include "Resources/ResourceManager.h"
 #include "Scene/Components/Lights/DirectionalLightComponent.h"
@@ -15,6 +16,13 @@
 
 #include <vector>
 
+namespace
+{
+   const UniformHandle kLocalToClipUniform("uLocalToClip");
+   const UniformHandle kLightIndexUniform("uLightIndex");
+   const UniformHandle kShadowMapUniform("uShadowMap");
+}
+
 DeferredSceneRenderer::DeferredSceneRenderer(const SPtr<ResourceManager>& inResourceManager)
    : SceneRenderer(inResourceManager, true)
 {
@@ -91,24 +99,29 @@ DeferredSceneRenderer::DeferredSceneRenderer(const SPtr<ResourceManager>& inReso
       shaderSpecifications[1].type = ShaderType::Fragment;
       IOUtils::getAbsoluteResourcePath("Shaders/DeferredLighting.vert", shaderSpecifications[0].path);
       IOUtils::getAbsoluteResourcePath("Shaders/DeferredLighting.frag", shaderSpecifications[1].path);
+      addLightDefinitions(shaderSpecifications[0]);
+      addLightDefinitions(shaderSpecifications[1]);
 
       shaderSpecifications[0].definitions["LIGHT_TYPE"] = "DIRECTIONAL_LIGHT";
       shaderSpecifications[1].definitions["LIGHT_TYPE"] = "DIRECTIONAL_LIGHT";
       directionalLightingProgram = getResourceManager().loadShaderProgram(shaderSpecifications);
       directionalLightingProgram->bindUniformBuffer(GraphicsContext::current().getFramebufferUniformBuffer());
       directionalLightingProgram->bindUniformBuffer(getViewUniformBuffer());
+      directionalLightingProgram->bindUniformBuffer(getLightUniformBuffer());
 
       shaderSpecifications[0].definitions["LIGHT_TYPE"] = "POINT_LIGHT";
       shaderSpecifications[1].definitions["LIGHT_TYPE"] = "POINT_LIGHT";
       pointLightingProgram = getResourceManager().loadShaderProgram(shaderSpecifications);
       pointLightingProgram->bindUniformBuffer(GraphicsContext::current().getFramebufferUniformBuffer());
       pointLightingProgram->bindUniformBuffer(getViewUniformBuffer());
+      pointLightingProgram->bindUniformBuffer(getLightUniformBuffer());
 
       shaderSpecifications[0].definitions["LIGHT_TYPE"] = "SPOT_LIGHT";
       shaderSpecifications[1].definitions["LIGHT_TYPE"] = "SPOT_LIGHT";
       spotLightingProgram = getResourceManager().loadShaderProgram(shaderSpecifications);
       spotLightingProgram->bindUniformBuffer(GraphicsContext::current().getFramebufferUniformBuffer());
       spotLightingProgram->bindUniformBuffer(getViewUniformBuffer());
+      spotLightingProgram->bindUniformBuffer(getLightUniformBuffer());
    }
 
    {
@@ -148,7 +161,7 @@ DeferredSceneRenderer::DeferredSceneRenderer(const SPtr<ResourceManager>& inReso
    setTonemapTextures(hdrColorTexture, getBloomPassFramebuffer().getColorAttachment(0));
 }
 
-void DeferredSceneRenderer::renderScene(const Scene& scene)
+void DeferredSceneRenderer::renderScene(Scene& scene)
 {
    ViewInfo viewInfo;
    if (!getViewInfo(scene, viewInfo))
@@ -157,11 +170,11 @@ void DeferredSceneRenderer::renderScene(const Scene& scene)
    }
    setView(viewInfo);
 
-   SceneRenderInfo sceneRenderInfo = calcSceneRenderInfo(scene, viewInfo, true);
+   SceneRenderInfo sceneRenderInfo = calcSceneRenderInfo(scene, viewInfo);
    renderPrePass(sceneRenderInfo);
    renderBasePass(sceneRenderInfo);
    renderSSAOPass(sceneRenderInfo);
-   renderShadowMaps(scene, sceneRenderInfo);
+   renderShadowMaps(sceneRenderInfo);
    renderLightingPass(sceneRenderInfo);
    renderTranslucencyPass(sceneRenderInfo);
    renderPostProcessPasses(sceneRenderInfo);
@@ -192,31 +205,13 @@ void DeferredSceneRenderer::renderBasePass(const SceneRenderInfo& sceneRenderInf
 
    glClear(GL_COLOR_BUFFER_BIT);
 
-   for (const ModelRenderInfo& modelRenderInfo : sceneRenderInfo.modelRenderInfo)
+   for (const InstancedDrawBatch& batch : prepareInstancedDraws(sceneRenderInfo.modelRenderInfo, sceneRenderInfo.opaqueSectionRenderInfo, true))
    {
-      ASSERT(modelRenderInfo.model);
-
-      glm::mat4 localToWorld = modelRenderInfo.localToWorld.toMatrix();
-      glm::mat4 localToNormal = glm::transpose(glm::inverse(localToWorld));
-
-      for (std::size_t i = 0; i < modelRenderInfo.model->getNumMeshSections(); ++i)
-      {
-         const MeshSection& section = modelRenderInfo.model->getMeshSection(i);
-         const Material& material = modelRenderInfo.model->getMaterial(i);
-
-         bool visible = i >= modelRenderInfo.visibilityMask.size() || modelRenderInfo.visibilityMask[i];
-         if (visible && material.getBlendMode() == BlendMode::Opaque)
-         {
-            SPtr<ShaderProgram>& gBufferProgramPermutation = selectGBufferPermutation(material);
+      SPtr<ShaderProgram>& gBufferProgramPermutation = selectGBufferPermutation(*batch.material);
 
-            gBufferProgramPermutation->setUniformValue(UniformNames::kLocalToWorld, localToWorld);
-            gBufferProgramPermutation->setUniformValue(UniformNames::kLocalToNormal, localToNormal, false);
-
-            DrawingContext context(gBufferProgramPermutation.get());
-            material.apply(context);
-            section.draw(context);
-         }
-      }
+      DrawingContext context(gBufferProgramPermutation.get());
+      batch.material->apply(context);
+      submitInstancedDraws(context, batch);
    }
 }
 
@@ -234,22 +229,17 @@ void DeferredSceneRenderer::renderLightingPass(const SceneRenderInfo& sceneRende
    baseRasterizerState.destinationBlendFactor = BlendFactor::One;
    RasterizerStateScope baseRasterierStateScope(baseRasterizerState);
 
-   for (const DirectionalLightRenderInfo& directionalLightRenderInfo : sceneRenderInfo.directionalLights)
+   // Light data comes from the light uniform buffer, only the index and shadow map need to be set per light
+   for (int i = 0; i < static_cast<int>(sceneRenderInfo.directionalLights.size()); ++i)
    {
+      const DirectionalLightRenderInfo& directionalLightRenderInfo = sceneRenderInfo.directionalLights[i];
       DrawingContext context(directionalLightingProgram.get());
 
-      DirectionalLightUniformData uniformData = directionalLightRenderInfo.getUniformData();
-
-      directionalLightingProgram->setUniformValue("uDirectionalLight.color", uniformData.color);
-      directionalLightingProgram->setUniformValue("uDirectionalLight.direction", uniformData.direction);
+      directionalLightingProgram->setUniformValue(kLightIndexUniform, selectLightUniformIndex(sceneRenderInfo, LightType::Directional, i));
 
-      directionalLightingProgram->setUniformValue("uDirectionalLight.castShadows", uniformData.castShadows);
-      directionalLightingProgram->setUniformValue("uDirectionalLight.worldToShadow", uniformData.worldToShadow);
-      directionalLightingProgram->setUniformValue("uDirectionalLight.shadowBias", uniformData.shadowBias);
-
-      const SPtr<Texture>& shadowMap = uniformData.shadowMap ? uniformData.shadowMap : getDummyShadowMap();
+      const SPtr<Texture>& shadowMap = directionalLightRenderInfo.shadowMapFramebuffer ? directionalLightRenderInfo.shadowMapFramebuffer->getDepthStencilAttachment() : getDummyShadowMap();
       GLint shadowMapTextureUnit = shadowMap->activateAndBind(context);
-      directionalLightingProgram->setUniformValue("uDirectionalLight.shadowMap", shadowMapTextureUnit);
+      directionalLightingProgram->setUniformValue(kShadowMapUniform, shadowMapTextureUnit);
 
       lightingMaterial.apply(context);
       getScreenMesh().draw(context);
@@ -260,8 +250,9 @@ void DeferredSceneRenderer::renderLightingPass(const SceneRenderInfo& sceneRende
       pointAndSpotRasterizerState.faceCullMode = FaceCullMode::Front;
       RasterizerStateScope pointAndSpotRasterizerStateScope(pointAndSpotRasterizerState);
 
-      for (const PointLightRenderInfo& pointLightRenderInfo : sceneRenderInfo.pointLights)
+      for (int i = 0; i < static_cast<int>(sceneRenderInfo.pointLights.size()); ++i)
       {
+         const PointLightRenderInfo& pointLightRenderInfo = sceneRenderInfo.pointLights[i];
          DrawingContext context(pointLightingProgram.get());
 
          PointLightUniformData uniformData = pointLightRenderInfo.getUniformData();
@@ -270,26 +261,21 @@ void DeferredSceneRenderer::renderLightingPass(const SceneRenderInfo& sceneRende
          ASSERT(component);
          Transform transform = component->getAbsoluteTransform();
          transform.scale = glm::vec3(uniformData.radius);
-         pointLightingProgram->setUniformValue("uLocalToClip", sceneRenderInfo.viewInfo.getWorldToClip() * transform.toMatrix());
-
-         pointLightingProgram->setUniformValue("uPointLight.color", uniformData.color);
-         pointLightingProgram->setUniformValue("uPointLight.position", uniformData.position);
-         pointLightingProgram->setUniformValue("uPointLight.radius", uniformData.radius);
+         pointLightingProgram->setUniformValue(kLocalToClipUniform, sceneRenderInfo.viewInfo.getWorldToClip() * transform.toMatrix());
 
-         pointLightingProgram->setUniformValue("uPointLight.castShadows", uniformData.castShadows);
-         pointLightingProgram->setUniformValue("uPointLight.nearFar", uniformData.nearFar);
-         pointLightingProgram->setUniformValue("uPointLight.shadowBias", uniformData.shadowBias);
+         pointLightingProgram->setUniformValue(kLightIndexUniform, selectLightUniformIndex(sceneRenderInfo, LightType::Point, i));
 
          const SPtr<Texture>& shadowMap = uniformData.shadowMap ? uniformData.shadowMap : getDummyShadowCubeMap();
          GLint shadowMapTextureUnit = shadowMap->activateAndBind(context);
-         pointLightingProgram->setUniformValue("uPointLight.shadowMap", shadowMapTextureUnit);
+         pointLightingProgram->setUniformValue(kShadowMapUniform, shadowMapTextureUnit);
 
          lightingMaterial.apply(context);
          sphereMesh->draw(context);
       }
 
-      for (const SpotLightRenderInfo& spotLightRenderInfo : sceneRenderInfo.spotLights)
+      for (int i = 0; i < static_cast<int>(sceneRenderInfo.spotLights.size()); ++i)
       {
+         const SpotLightRenderInfo& spotLightRenderInfo = sceneRenderInfo.spotLights[i];
          DrawingContext context(spotLightingProgram.get());
 
          SpotLightUniformData uniformData = spotLightRenderInfo.getUniformData();
@@ -299,21 +285,13 @@ void DeferredSceneRenderer::renderLightingPass(const SceneRenderInfo& sceneRende
          Transform transform = component->getAbsoluteTransform();
          float widthScale = glm::tan(uniformData.cutoffAngle) * uniformData.radius * 2.0f;
          transform.scale = glm::vec3(widthScale, widthScale, uniformData.radius);
-         spotLightingProgram->setUniformValue("uLocalToClip", sceneRenderInfo.viewInfo.getWorldToClip() * transform.toMatrix());
-
-         spotLightingProgram->setUniformValue("uSpotLight.color", uniformData.color);
-         spotLightingProgram->setUniformValue("uSpotLight.direction", uniformData.direction);
-         spotLightingProgram->setUniformValue("uSpotLight.position", uniformData.position);
-         spotLightingProgram->setUniformValue("uSpotLight.radius", uniformData.radius);
-         spotLightingProgram->setUniformValue("uSpotLight.beamAngle", uniformData.beamAngle);
-         spotLightingProgram->setUniformValue("uSpotLight.cutoffAngle", uniformData.cutoffAngle);
-         spotLightingProgram->setUniformValue("uSpotLight.castShadows", uniformData.castShadows);
-         spotLightingProgram->setUniformValue("uSpotLight.worldToShadow", uniformData.worldToShadow);
-         spotLightingProgram->setUniformValue("uSpotLight.shadowBias", uniformData.shadowBias);
+         spotLightingProgram->setUniformValue(kLocalToClipUniform, sceneRenderInfo.viewInfo.getWorldToClip() * transform.toMatrix());
+
+         spotLightingProgram->setUniformValue(kLightIndexUniform, selectLightUniformIndex(sceneRenderInfo, LightType::Spot, i));
 
          const SPtr<Texture>& shadowMap = uniformData.shadowMap ? uniformData.shadowMap : getDummyShadowMap();
          GLint shadowMapTextureUnit = shadowMap->activateAndBind(context);
-         spotLightingProgram->setUniformValue("uSpotLight.shadowMap", shadowMapTextureUnit);
+         spotLightingProgram->setUniformValue(kShadowMapUniform, shadowMapTextureUnit);
 
          lightingMaterial.apply(context);
          coneMesh->draw(context);
@@ -349,6 +327,7 @@ void DeferredSceneRenderer::loadGBufferProgramPermutations()
 
       gBufferProgramPermutations[i] = getResourceManager().loadShaderProgram(shaderSpecifications);
       gBufferProgramPermutations[i]->bindUniformBuffer(getViewUniformBuffer());
+      Material::bindConstantsBlock(*gBufferProgramPermutations[i]);
    }
 }
 
@@ -14,7 +14,7 @@ class DeferredSceneRenderer : public SceneRenderer
 public:
    DeferredSceneRenderer(const SPtr<ResourceManager>& inResourceManager);
 
-   void renderScene(const Scene& scene) override;
+   void renderScene(Scene& scene) override;
 
    void onFramebufferSizeChanged(int newWidth, int newHeight) override;
 
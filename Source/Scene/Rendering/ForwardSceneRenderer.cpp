@@ -71,7 +71,7 @@ ForwardSceneRenderer::ForwardSceneRenderer(int numSamples, const SPtr<ResourceMa
    setTonemapTextures(hdrColorTexture, getBloomPassFramebuffer().getColorAttachment(0));
 }
 
-void ForwardSceneRenderer::renderScene(const Scene& scene)
+void ForwardSceneRenderer::renderScene(Scene& scene)
 {
    ViewInfo viewInfo;
    if (!getViewInfo(scene, viewInfo))
@@ -80,11 +80,11 @@ void ForwardSceneRenderer::renderScene(const Scene& scene)
    }
    setView(viewInfo);
 
-   SceneRenderInfo sceneRenderInfo = calcSceneRenderInfo(scene, viewInfo, true);
+   SceneRenderInfo sceneRenderInfo = calcSceneRenderInfo(scene, viewInfo);
    renderPrePass(sceneRenderInfo);
    renderNormalPass(sceneRenderInfo);
    renderSSAOPass(sceneRenderInfo);
-   renderShadowMaps(scene, sceneRenderInfo);
+   renderShadowMaps(sceneRenderInfo);
    renderMainPass(sceneRenderInfo);
    renderTranslucencyPass(sceneRenderInfo);
    renderPostProcessPasses(sceneRenderInfo);
@@ -111,31 +111,13 @@ void ForwardSceneRenderer::renderNormalPass(const SceneRenderInfo& sceneRenderIn
 
    glClear(GL_COLOR_BUFFER_BIT);
 
-   for (const ModelRenderInfo& modelRenderInfo : sceneRenderInfo.modelRenderInfo)
+   for (const InstancedDrawBatch& batch : prepareInstancedDraws(sceneRenderInfo.modelRenderInfo, sceneRenderInfo.opaqueSectionRenderInfo, true))
    {
-      ASSERT(modelRenderInfo.model);
+      SPtr<ShaderProgram>& normalProgramPermutation = selectNormalPermutation(*batch.material);
 
-      glm::mat4 localToWorld = modelRenderInfo.localToWorld.toMatrix();
-      glm::mat4 localToNormal = glm::transpose(glm::inverse(localToWorld));
-
-      for (std::size_t i = 0; i < modelRenderInfo.model->getNumMeshSections(); ++i)
-      {
-         const MeshSection& section = modelRenderInfo.model->getMeshSection(i);
-         const Material& material = modelRenderInfo.model->getMaterial(i);
-
-         bool visible = i >= modelRenderInfo.visibilityMask.size() || modelRenderInfo.visibilityMask[i];
-         if (visible && material.getBlendMode() == BlendMode::Opaque)
-         {
-            SPtr<ShaderProgram>& normalProgramPermutation = selectNormalPermutation(material);
-
-            normalProgramPermutation->setUniformValue(UniformNames::kLocalToWorld, localToWorld);
-            normalProgramPermutation->setUniformValue(UniformNames::kLocalToNormal, localToNormal, false);
-
-            DrawingContext context(normalProgramPermutation.get());
-            material.apply(context);
-            section.draw(context);
-         }
-      }
+      DrawingContext context(normalProgramPermutation.get());
+      batch.material->apply(context);
+      submitInstancedDraws(context, batch);
    }
 }
 
@@ -152,33 +134,14 @@ void ForwardSceneRenderer::renderMainPass(const SceneRenderInfo& sceneRenderInfo
    std::array<DrawingContext, 8> contexts;
    populateForwardUniforms(sceneRenderInfo, contexts);
 
-   for (const ModelRenderInfo& modelRenderInfo : sceneRenderInfo.modelRenderInfo)
+   for (const InstancedDrawBatch& batch : prepareInstancedDraws(sceneRenderInfo.modelRenderInfo, sceneRenderInfo.opaqueSectionRenderInfo, true))
    {
-      ASSERT(modelRenderInfo.model);
-
-      glm::mat4 localToWorld = modelRenderInfo.localToWorld.toMatrix();
-      glm::mat4 localToNormal = glm::transpose(glm::inverse(localToWorld));
+      int permutationIndex = selectForwardPermutation(*batch.material);
 
-      for (std::size_t i = 0; i < modelRenderInfo.model->getNumMeshSections(); ++i)
-      {
-         const MeshSection& section = modelRenderInfo.model->getMeshSection(i);
-         const Material& material = modelRenderInfo.model->getMaterial(i);
-
-         bool visible = i >= modelRenderInfo.visibilityMask.size() || modelRenderInfo.visibilityMask[i];
-         if (visible && material.getBlendMode() == BlendMode::Opaque)
-         {
-            int permutationIndex = selectForwardPermutation(material);
-            DrawingContext& permutationContext = contexts[permutationIndex];
-
-            permutationContext.program->setUniformValue(UniformNames::kLocalToWorld, localToWorld);
-            permutationContext.program->setUniformValue(UniformNames::kLocalToNormal, localToNormal, false);
-
-            DrawingContext localContext = permutationContext;
-            getForwardMaterial().apply(localContext);
-            material.apply(localContext);
-            section.draw(localContext);
-         }
-      }
+      DrawingContext localContext = contexts[permutationIndex];
+      getForwardMaterial().apply(localContext);
+      batch.material->apply(localContext);
+      submitInstancedDraws(localContext, batch);
    }
 }
 
@@ -208,6 +171,7 @@ void ForwardSceneRenderer::loadNormalProgramPermutations()
 
       normalProgramPermutations[i] = getResourceManager().loadShaderProgram(shaderSpecifications);
       normalProgramPermutations[i]->bindUniformBuffer(getViewUniformBuffer());
+      Material::bindConstantsBlock(*normalProgramPermutations[i]);
    }
 }
 
@@ -15,7 +15,7 @@ class ForwardSceneRenderer : public SceneRenderer
 public:
    ForwardSceneRenderer(int numSamples, const SPtr<ResourceManager>& inResourceManager);
 
-   void renderScene(const Scene& scene) override;
+   void renderScene(Scene& scene) override;
 
    void onFramebufferSizeChanged(int newWidth, int newHeight) override;
 
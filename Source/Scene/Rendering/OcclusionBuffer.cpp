@@ -0,0 +1,278 @@
+#include "Scene/Rendering/OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SWAP_OCCLUSION_SSE 1
+#  include <emmintrin.h>
+#endif
+
+namespace
+{
+   // Anything this close to (or behind) the eye can't be reliably projected
+   const float kMinProjectedDepth = 1.0e-3f;
+
+   const float kNoOccluder = std::numeric_limits<float>::max();
+
+   // Corner index bits select the max (1) or min (0) value along x, y, and z
+   const std::array<std::array<int, 4>, 6> kBoxFaces =
+   { {
+      { 0, 2, 6, 4 }, // -x
+      { 1, 3, 7, 5 }, // +x
+      { 0, 1, 5, 4 }, // -y
+      { 2, 3, 7, 6 }, // +y
+      { 0, 1, 3, 2 }, // -z
+      { 4, 5, 7, 6 }  // +z
+   } };
+
+   std::array<glm::vec3, 8> getCorners(const glm::vec3& min, const glm::vec3& max)
+   {
+      std::array<glm::vec3, 8> corners;
+      for (std::size_t i = 0; i < corners.size(); ++i)
+      {
+         corners[i] = glm::vec3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+      }
+
+      return corners;
+   }
+
+   struct EdgeFunction
+   {
+      float a = 0.0f;
+      float b = 0.0f;
+      float c = 0.0f;
+      float fullCoverageThreshold = 0.0f;
+
+      float evaluate(float x, float y) const
+      {
+         return a * x + b * y + c;
+      }
+   };
+
+   // Returns true if all pixels within [minX, maxX) x [minY, maxY) are closer than the given depth
+   bool allCloser(const std::vector<float>& depth, int width, int minX, int maxX, int minY, int maxY, float testDepth)
+   {
+      for (int y = minY; y < maxY; ++y)
+      {
+         const float* row = &depth[y * width];
+         int x = minX;
+
+#if SWAP_OCCLUSION_SSE
+         __m128 test = _mm_set1_ps(testDepth);
+         for (; x + 4 <= maxX; x += 4)
+         {
+            if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), test)) != 0)
+            {
+               return false;
+            }
+         }
+#endif
+
+         for (; x < maxX; ++x)
+         {
+            if (row[x] >= testDepth)
+            {
+               return false;
+            }
+         }
+      }
+
+      return true;
+   }
+}
+
+OcclusionBuffer::OcclusionBuffer()
+   : worldToClip(1.0f)
+   , depth(kWidth * kHeight, kNoOccluder)
+   , numOccluders(0)
+{
+}
+
+void OcclusionBuffer::reset(const glm::mat4& newWorldToClip)
+{
+   worldToClip = newWorldToClip;
+   std::fill(depth.begin(), depth.end(), kNoOccluder);
+   numOccluders = 0;
+}
+
+void OcclusionBuffer::rasterizeOccluder(const Bounds& localBounds, const glm::mat4& localToWorld)
+{
+   std::array<glm::vec3, 8> corners = getCorners(localBounds.getMin(), localBounds.getMax());
+   for (glm::vec3& corner : corners)
+   {
+      corner = glm::vec3(localToWorld * glm::vec4(corner, 1.0f));
+   }
+
+   // Occluders that cross the near plane are skipped entirely, which is always safe
+   std::array<ScreenVertex, 8> screenVertices;
+   if (!projectCorners(corners, screenVertices))
+   {
+      return;
+   }
+
+   for (const std::array<int, 4>& face : kBoxFaces)
+   {
+      rasterizeQuad(screenVertices[face[0]], screenVertices[face[1]], screenVertices[face[2]], screenVertices[face[3]]);
+   }
+
+   ++numOccluders;
+}
+
+bool OcclusionBuffer::isOccluded(const Bounds& worldBounds) const
+{
+   if (numOccluders == 0)
+   {
+      return false;
+   }
+
+   glm::vec3 extent = glm::abs(worldBounds.extent);
+   std::array<ScreenVertex, 8> screenVertices;
+   if (!projectCorners(getCorners(worldBounds.center - extent, worldBounds.center + extent), screenVertices))
+   {
+      return false;
+   }
+
+   glm::vec2 screenMin = screenVertices[0].position;
+   glm::vec2 screenMax = screenVertices[0].position;
+   float maxInverseDepth = screenVertices[0].inverseDepth;
+   for (const ScreenVertex& screenVertex : screenVertices)
+   {
+      screenMin = glm::min(screenMin, screenVertex.position);
+      screenMax = glm::max(screenMax, screenVertex.position);
+      maxInverseDepth = glm::max(maxInverseDepth, screenVertex.inverseDepth);
+   }
+
+   // Round the rectangle outwards, so that every pixel the bounds touch is tested
+   int minX = glm::clamp(static_cast<int>(std::floor(screenMin.x)), 0, kWidth);
+   int maxX = glm::clamp(static_cast<int>(std::ceil(screenMax.x)), 0, kWidth);
+   int minY = glm::clamp(static_cast<int>(std::floor(screenMin.y)), 0, kHeight);
+   int maxY = glm::clamp(static_cast<int>(std::ceil(screenMax.y)), 0, kHeight);
+   if (minX >= maxX || minY >= maxY)
+   {
+      return false;
+   }
+
+   float nearestDepth = 1.0f / maxInverseDepth;
+   return allCloser(depth, kWidth, minX, maxX, minY, maxY, nearestDepth);
+}
+
+bool OcclusionBuffer::projectCorners(const std::array<glm::vec3, 8>& worldCorners, std::array<ScreenVertex, 8>& screenVertices) const
+{
+   for (std::size_t i = 0; i < worldCorners.size(); ++i)
+   {
+      glm::vec4 clipPosition = worldToClip * glm::vec4(worldCorners[i], 1.0f);
+      if (clipPosition.w < kMinProjectedDepth)
+      {
+         return false;
+      }
+
+      float inverseW = 1.0f / clipPosition.w;
+      glm::vec2 ndc = glm::vec2(clipPosition.x, clipPosition.y) * inverseW;
+
+      screenVertices[i].position = (ndc * 0.5f + 0.5f) * glm::vec2(kWidth, kHeight);
+      screenVertices[i].inverseDepth = inverseW;
+   }
+
+   return true;
+}
+
+void OcclusionBuffer::rasterizeQuad(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2, const ScreenVertex& v3)
+{
+   std::array<const ScreenVertex*, 4> vertices = { &v0, &v1, &v2, &v3 };
+
+   float doubleArea = 0.0f;
+   for (std::size_t i = 0; i < vertices.size(); ++i)
+   {
+      const glm::vec2& current = vertices[i]->position;
+      const glm::vec2& next = vertices[(i + 1) % vertices.size()]->position;
+      doubleArea += current.x * next.y - next.x * current.y;
+   }
+
+   // Skip faces that are viewed edge-on
+   if (glm::abs(doubleArea) < 1.0e-4f)
+   {
+      return;
+   }
+   float windingSign = doubleArea > 0.0f ? 1.0f : -1.0f;
+
+   // Edge functions are positive inside the quad, regardless of winding
+   std::array<EdgeFunction, 4> edges;
+   for (std::size_t i = 0; i < vertices.size(); ++i)
+   {
+      const glm::vec2& current = vertices[i]->position;
+      const glm::vec2& next = vertices[(i + 1) % vertices.size()]->position;
+      glm::vec2 edge = next - current;
+
+      edges[i].a = -edge.y * windingSign;
+      edges[i].b = edge.x * windingSign;
+      edges[i].c = (edge.y * current.x - edge.x * current.y) * windingSign;
+
+      // The edge function's minimum over a pixel is at most this much below its value at the pixel's center
+      edges[i].fullCoverageThreshold = 0.5f * (glm::abs(edges[i].a) + glm::abs(edges[i].b));
+   }
+
+   // Inverse depth is affine in screen space across a planar face - find its gradient using the better conditioned of
+   // the two triangles that make up the quad
+   auto determinant = [](const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c)
+   {
+      glm::vec2 ab = b.position - a.position;
+      glm::vec2 ac = c.position - a.position;
+      return ab.x * ac.y - ab.y * ac.x;
+   };
+   bool useFirstTriangle = glm::abs(determinant(v0, v1, v2)) >= glm::abs(determinant(v0, v2, v3));
+   const ScreenVertex& t0 = v0;
+   const ScreenVertex& t1 = useFirstTriangle ? v1 : v2;
+   const ScreenVertex& t2 = useFirstTriangle ? v2 : v3;
+
+   float det = determinant(t0, t1, t2);
+   if (glm::abs(det) < 1.0e-6f)
+   {
+      return;
+   }
+
+   glm::vec2 e1 = t1.position - t0.position;
+   glm::vec2 e2 = t2.position - t0.position;
+   float d1 = t1.inverseDepth - t0.inverseDepth;
+   float d2 = t2.inverseDepth - t0.inverseDepth;
+   float gradientX = (d1 * e2.y - d2 * e1.y) / det;
+   float gradientY = (d2 * e1.x - d1 * e2.x) / det;
+   float depthSlack = 0.5f * (glm::abs(gradientX) + glm::abs(gradientY));
+
+   glm::vec2 screenMin = glm::min(glm::min(v0.position, v1.position), glm::min(v2.position, v3.position));
+   glm::vec2 screenMax = glm::max(glm::max(v0.position, v1.position), glm::max(v2.position, v3.position));
+   int minX = glm::clamp(static_cast<int>(std::floor(screenMin.x)), 0, kWidth);
+   int maxX = glm::clamp(static_cast<int>(std::ceil(screenMax.x)), 0, kWidth);
+   int minY = glm::clamp(static_cast<int>(std::floor(screenMin.y)), 0, kHeight);
+   int maxY = glm::clamp(static_cast<int>(std::ceil(screenMax.y)), 0, kHeight);
+
+   for (int y = minY; y < maxY; ++y)
+   {
+      float centerY = y + 0.5f;
+      float* row = &depth[y * kWidth];
+
+      for (int x = minX; x < maxX; ++x)
+      {
+         float centerX = x + 0.5f;
+
+         bool fullyCovered = true;
+         for (const EdgeFunction& edge : edges)
+         {
+            fullyCovered &= edge.evaluate(centerX, centerY) >= edge.fullCoverageThreshold;
+         }
+
+         if (!fullyCovered)
+         {
+            continue;
+         }
+
+         // Use the farthest depth of the face within the pixel
+         float inverseDepth = t0.inverseDepth + gradientX * (centerX - t0.position.x) + gradientY * (centerY - t0.position.y) - depthSlack;
+         if (inverseDepth > 0.0f)
+         {
+            row[x] = glm::min(row[x], 1.0f / inverseDepth);
+         }
+      }
+   }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Math/Bounds.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+// Low resolution software depth buffer, used to reject objects that are hidden behind designated occluders without any
+// GPU readback. Stores the (linear) view depth of the nearest occluder per pixel.
+class OcclusionBuffer
+{
+public:
+   static const int kWidth = 256;
+   static const int kHeight = 128;
+
+   OcclusionBuffer();
+
+   void reset(const glm::mat4& newWorldToClip);
+
+   // Rasterizes the local box as a solid occluder. Coverage and depth are both conservative (a pixel is only written if
+   // it is completely covered, with the farthest depth of the box face within it).
+   void rasterizeOccluder(const Bounds& localBounds, const glm::mat4& localToWorld);
+
+   bool isOccluded(const Bounds& worldBounds) const;
+
+   bool hasOccluders() const
+   {
+      return numOccluders > 0;
+   }
+
+private:
+   struct ScreenVertex
+   {
+      glm::vec2 position;
+      float inverseDepth = 0.0f;
+   };
+
+   bool projectCorners(const std::array<glm::vec3, 8>& worldCorners, std::array<ScreenVertex, 8>& screenVertices) const;
+   void rasterizeQuad(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2, const ScreenVertex& v3);
+
+   glm::mat4 worldToClip;
+   std::vector<float> depth;
+   int numOccluders;
+};
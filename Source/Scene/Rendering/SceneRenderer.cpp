@@ -1,10 +1,15 @@
 #include "Scene/Rendering/SceneRenderer.h"
 
 #include "Core/Assert.h"
+#include "Core/RadixSort.h"
+#include "Core/ThreadPool.h"
 #include "Graphics/DrawingContext.h"
+#include "Graphics/GeometryArena.h"
 #include "Graphics/GraphicsContext.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Texture.h"
+#include "Graphics/UniformHandle.h"
+#include "Math/FrustumCulling.h"
 #include "Math/MathUtils.h"
 #include "Platform/IOUtils.h"
 #include "Resources/ResourceManager.h"
@@ -18,14 +23,13 @@
 #include <glad/gl.h>
 #include <glm/gtx/compatibility.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <random>
-
-namespace UniformNames
-{
-   const char* kLocalToWorld = "uLocalToWorld";
-   const char* kLocalToNormal = "uLocalToNormal";
-}
+#include <string>
 
 namespace
 {
@@ -100,193 +104,171 @@ namespace
       return Mesh(std::move(sections));
    }
 
-   std::array<glm::vec4, 6> computeFrustumPlanes(const glm::mat4& worldToClip)
-   {
-      std::array<glm::vec4, 6> frustumPlanes;
-
-      for (int i = 0; i < frustumPlanes.size(); ++i)
-      {
-         glm::vec4& frustumPlane = frustumPlanes[i];
+   const float kLightNearPlane = 0.1f;
 
-         int row = i / 2;
-         int sign = (i % 2) == 0 ? 1 : -1;
+   // Anything closer than this is treated as being this far away when calculating its screen size
+   const float kMinScreenSizeDistance = 1.0e-3f;
 
-         frustumPlane.x = worldToClip[0][3] + sign * worldToClip[0][row];
-         frustumPlane.y = worldToClip[1][3] + sign * worldToClip[1][row];
-         frustumPlane.z = worldToClip[2][3] + sign * worldToClip[2][row];
-         frustumPlane.w = worldToClip[3][3] + sign * worldToClip[3][row];
+   // Roughly a pixel at 1080p
+   const float kDefaultMinScreenSize = 1.0e-3f;
+   const std::size_t kMaxDirectionalLights = 2;
+   const std::size_t kMaxPointLights = 8;
+   const std::size_t kMaxSpotLights = 8;
 
-         frustumPlane /= glm::length(glm::vec3(frustumPlane.x, frustumPlane.y, frustumPlane.z));
-      }
+   // std140 layouts of the light structs and uniform block in LightingCommon.glsl. Samplers can't be stored in blocks, so
+   // shadow maps are bound separately.
+   struct DirectionalLightBlockData
+   {
+      glm::vec3 color;
+      uint32_t castShadows;
+      glm::vec3 direction;
+      float shadowBias;
+      glm::mat4 worldToShadow;
+   };
 
-      return frustumPlanes;
-   }
+   struct PointLightBlockData
+   {
+      glm::vec3 color;
+      float radius;
+      glm::vec3 position;
+      uint32_t castShadows;
+      glm::vec2 nearFar;
+      float shadowBias;
+      float padding;
+   };
 
-   float signedPlaneDist(const glm::vec3& point, const glm::vec4& plane)
+   struct SpotLightBlockData
    {
-      return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
-   }
+      glm::vec3 color;
+      float radius;
+      glm::vec3 direction;
+      float beamAngle;
+      glm::vec3 position;
+      float cutoffAngle;
+      uint32_t castShadows;
+      float shadowBias;
+      glm::vec2 padding;
+      glm::mat4 worldToShadow;
+   };
 
-   bool outside(const std::array<glm::vec3, 8>& points, const glm::vec4& plane)
+   struct LightBlockData
    {
-      for (const glm::vec3& point : points)
-      {
-         if (signedPlaneDist(point, plane) >= 0.0f)
-         {
-            return false;
-         }
-      }
+      std::array<DirectionalLightBlockData, kMaxDirectionalLights> directionalLights;
+      std::array<PointLightBlockData, kMaxPointLights> pointLights;
+      std::array<SpotLightBlockData, kMaxSpotLights> spotLights;
+
+      int32_t numDirectionalLights;
+      int32_t numPointLights;
+      int32_t numSpotLights;
+      int32_t padding;
+   };
 
-      return true;
-   }
+   static_assert(sizeof(DirectionalLightBlockData) == 96, "Directional light data must match its std140 layout");
+   static_assert(sizeof(PointLightBlockData) == 48, "Point light data must match its std140 layout");
+   static_assert(sizeof(SpotLightBlockData) == 128, "Spot light data must match its std140 layout");
+   static_assert(offsetof(LightBlockData, numDirectionalLights) == 2 * 96 + 8 * 48 + 8 * 128, "Light block data must match its std140 layout");
 
-   bool frustumCull(const Bounds& bounds, const std::array<glm::vec4, 6>& frustumPlanes)
+   DirectionalLightBlockData getBlockData(const DirectionalLightUniformData& uniformData)
    {
-      // First check if the bounding sphere is completely outside of any of the planes
-      for (const glm::vec4& plane : frustumPlanes)
-      {
-         if (signedPlaneDist(bounds.center, plane) < -bounds.radius)
-         {
-            return true;
-         }
-      }
+      DirectionalLightBlockData blockData;
 
-      // Next, check the bounding box
-      glm::vec3 min = bounds.getMin();
-      glm::vec3 max = bounds.getMax();
-      std::array<glm::vec3, 8> corners =
-      {
-         glm::vec3(min.x, min.y, min.z),
-         glm::vec3(min.x, min.y, max.z),
-         glm::vec3(min.x, max.y, min.z),
-         glm::vec3(min.x, max.y, max.z),
-         glm::vec3(max.x, min.y, min.z),
-         glm::vec3(max.x, min.y, max.z),
-         glm::vec3(max.x, max.y, min.z),
-         glm::vec3(max.x, max.y, max.z)
-      };
-      for (const glm::vec4& plane : frustumPlanes)
-      {
-         if (outside(corners, plane))
-         {
-            return true;
-         }
-      }
+      blockData.color = uniformData.color;
+      blockData.castShadows = uniformData.castShadows;
+      blockData.direction = uniformData.direction;
+      blockData.shadowBias = uniformData.shadowBias;
+      blockData.worldToShadow = uniformData.worldToShadow;
 
-      return false;
+      return blockData;
    }
 
-   const float kLightNearPlane = 0.1f;
-   const int kMaxDirectionalLights = 2;
-   const int kMaxPointLights = 8;
-   const int kMaxSpotLights = 8;
-
-   void populateDirectionalLightUniforms(const SceneRenderInfo& sceneRenderInfo, DrawingContext& context, const SPtr<Texture>& dummyShadowMap)
+   PointLightBlockData getBlockData(const PointLightUniformData& uniformData)
    {
-      ASSERT(context.program);
-      ASSERT(dummyShadowMap);
+      PointLightBlockData blockData;
 
-      ShaderProgram& program = *context.program;
-
-      for (int directionalLightIndex = 0; directionalLightIndex < kMaxDirectionalLights; ++directionalLightIndex)
-      {
-         DirectionalLightUniformData uniformData;
-         if (directionalLightIndex < sceneRenderInfo.directionalLights.size())
-         {
-            uniformData = sceneRenderInfo.directionalLights[directionalLightIndex].getUniformData();
-         }
+      blockData.color = uniformData.color;
+      blockData.radius = uniformData.radius;
+      blockData.position = uniformData.position;
+      blockData.castShadows = uniformData.castShadows;
+      blockData.nearFar = uniformData.nearFar;
+      blockData.shadowBias = uniformData.shadowBias;
+      blockData.padding = 0.0f;
 
-         std::string directionalLightStr = "uDirectionalLights[" + std::to_string(directionalLightIndex) + "]";
+      return blockData;
+   }
 
-         program.setUniformValue(directionalLightStr + ".color", uniformData.color);
-         program.setUniformValue(directionalLightStr + ".direction", uniformData.direction);
+   SpotLightBlockData getBlockData(const SpotLightUniformData& uniformData)
+   {
+      SpotLightBlockData blockData;
+
+      blockData.color = uniformData.color;
+      blockData.radius = uniformData.radius;
+      blockData.direction = uniformData.direction;
+      blockData.beamAngle = uniformData.beamAngle;
+      blockData.position = uniformData.position;
+      blockData.cutoffAngle = uniformData.cutoffAngle;
+      blockData.castShadows = uniformData.castShadows;
+      blockData.shadowBias = uniformData.shadowBias;
+      blockData.padding = glm::vec2(0.0f);
+      blockData.worldToShadow = uniformData.worldToShadow;
+
+      return blockData;
+   }
 
-         program.setUniformValue(directionalLightStr + ".castShadows", uniformData.castShadows);
-         program.setUniformValue(directionalLightStr + ".worldToShadow", uniformData.worldToShadow);
-         program.setUniformValue(directionalLightStr + ".shadowBias", uniformData.shadowBias);
+   // Packs the lights starting at the given one into the block's array, and returns how many of them fit
+   template<typename RenderInfoType, typename BlockDataType, std::size_t kMaxLights>
+   int32_t packLights(const FrameVector<RenderInfoType>& lights, int firstLight, std::array<BlockDataType, kMaxLights>& blockData)
+   {
+      int32_t numLights = static_cast<int32_t>(std::min<std::size_t>(lights.size() - std::min<std::size_t>(lights.size(), firstLight), kMaxLights));
 
-         const SPtr<Texture>& shadowMap = uniformData.shadowMap ? uniformData.shadowMap : dummyShadowMap;
-         GLint shadowMapTextureUnit = shadowMap->activateAndBind(context);
-         program.setUniformValue(directionalLightStr + ".shadowMap", shadowMapTextureUnit);
+      for (int32_t i = 0; i < numLights; ++i)
+      {
+         blockData[i] = getBlockData(lights[firstLight + i].getUniformData());
+      }
+      for (std::size_t i = numLights; i < kMaxLights; ++i)
+      {
+         blockData[i] = BlockDataType{};
       }
 
-      program.setUniformValue("uNumDirectionalLights", static_cast<int>(sceneRenderInfo.directionalLights.size()));
+      return numLights;
    }
 
-   void populatePointLightUniforms(const SceneRenderInfo& sceneRenderInfo, DrawingContext& context, const SPtr<Texture>& dummyShadowCubeMap)
+   template<std::size_t kSize>
+   std::array<UniformHandle, kSize> getArrayUniformHandles(const char* baseName)
    {
-      ASSERT(context.program);
-      ASSERT(dummyShadowCubeMap);
-
-      ShaderProgram& program = *context.program;
+      std::array<UniformHandle, kSize> handles;
 
-      for (int pointLightIndex = 0; pointLightIndex < kMaxPointLights; ++pointLightIndex)
+      for (std::size_t i = 0; i < kSize; ++i)
       {
-         PointLightUniformData uniformData;
-         if (pointLightIndex < sceneRenderInfo.pointLights.size())
-         {
-            uniformData = sceneRenderInfo.pointLights[pointLightIndex].getUniformData();
-         }
-
-         std::string pointLightStr = "uPointLights[" + std::to_string(pointLightIndex) + "]";
-
-         program.setUniformValue(pointLightStr + ".color", uniformData.color);
-         program.setUniformValue(pointLightStr + ".position", uniformData.position);
-         program.setUniformValue(pointLightStr + ".radius", uniformData.radius);
-
-         program.setUniformValue(pointLightStr + ".castShadows", uniformData.castShadows);
-         program.setUniformValue(pointLightStr + ".nearFar", uniformData.nearFar);
-         program.setUniformValue(pointLightStr + ".shadowBias", uniformData.shadowBias);
-
-         const SPtr<Texture>& shadowMap = uniformData.shadowMap ? uniformData.shadowMap : dummyShadowCubeMap;
-         GLint shadowMapTextureUnit = shadowMap->activateAndBind(context);
-         program.setUniformValue(pointLightStr + ".shadowMap", shadowMapTextureUnit);
+         handles[i] = UniformHandle(std::string(baseName) + "[" + std::to_string(i) + "]");
       }
 
-      program.setUniformValue("uNumPointLights", static_cast<int>(sceneRenderInfo.pointLights.size()));
+      return handles;
    }
 
-   void populateSpotLightUniforms(const SceneRenderInfo& sceneRenderInfo, DrawingContext& context, const SPtr<Texture>& dummyShadowMap)
+   template<typename RenderInfoType, std::size_t kMaxLights>
+   void bindShadowMaps(const FrameVector<RenderInfoType>& lights, const std::array<UniformHandle, kMaxLights>& uniformHandles, DrawingContext& context, const SPtr<Texture>& dummyShadowMap)
    {
       ASSERT(context.program);
       ASSERT(dummyShadowMap);
 
-      ShaderProgram& program = *context.program;
-
-      for (int spotLightIndex = 0; spotLightIndex < kMaxSpotLights; ++spotLightIndex)
+      for (std::size_t i = 0; i < kMaxLights; ++i)
       {
-         SpotLightUniformData uniformData;
-         if (spotLightIndex < sceneRenderInfo.spotLights.size())
-         {
-            uniformData = sceneRenderInfo.spotLights[spotLightIndex].getUniformData();
-         }
-
-         std::string spotLightStr = "uSpotLights[" + std::to_string(spotLightIndex) + "]";
-
-         program.setUniformValue(spotLightStr + ".color", uniformData.color);
-         program.setUniformValue(spotLightStr + ".direction", uniformData.direction);
-         program.setUniformValue(spotLightStr + ".position", uniformData.position);
-         program.setUniformValue(spotLightStr + ".radius", uniformData.radius);
-         program.setUniformValue(spotLightStr + ".beamAngle", uniformData.beamAngle);
-         program.setUniformValue(spotLightStr + ".cutoffAngle", uniformData.cutoffAngle);
-
-         program.setUniformValue(spotLightStr + ".castShadows", uniformData.castShadows);
-         program.setUniformValue(spotLightStr + ".worldToShadow", uniformData.worldToShadow);
-         program.setUniformValue(spotLightStr + ".shadowBias", uniformData.shadowBias);
-
-         const SPtr<Texture>& shadowMap = uniformData.shadowMap ? uniformData.shadowMap : dummyShadowMap;
+         const SPtr<Texture>& shadowMap = i < lights.size() && lights[i].shadowMapFramebuffer ? lights[i].shadowMapFramebuffer->getDepthStencilAttachment() : dummyShadowMap;
          GLint shadowMapTextureUnit = shadowMap->activateAndBind(context);
-         program.setUniformValue(spotLightStr + ".shadowMap", shadowMapTextureUnit);
+         context.program->setUniformValue(uniformHandles[i], shadowMapTextureUnit);
       }
-
-      program.setUniformValue("uNumSpotLights", static_cast<int>(sceneRenderInfo.spotLights.size()));
    }
 
-   void populateLightUniforms(const SceneRenderInfo& sceneRenderInfo, DrawingContext& context, const SPtr<Texture>& dummyShadowMap, const SPtr<Texture>& dummyShadowCubeMap)
+   // Every forward program binds its shadow maps to the same texture units, so only the first one actually binds anything
+   void bindForwardShadowMaps(const SceneRenderInfo& sceneRenderInfo, DrawingContext& context, const SPtr<Texture>& dummyShadowMap, const SPtr<Texture>& dummyShadowCubeMap)
    {
-      populateDirectionalLightUniforms(sceneRenderInfo, context, dummyShadowMap);
-      populatePointLightUniforms(sceneRenderInfo, context, dummyShadowCubeMap);
-      populateSpotLightUniforms(sceneRenderInfo, context, dummyShadowMap);
+      static const std::array<UniformHandle, kMaxDirectionalLights> kDirectionalShadowMapUniforms = getArrayUniformHandles<kMaxDirectionalLights>("uDirectionalShadowMaps");
+      static const std::array<UniformHandle, kMaxPointLights> kPointShadowMapUniforms = getArrayUniformHandles<kMaxPointLights>("uPointShadowMaps");
+      static const std::array<UniformHandle, kMaxSpotLights> kSpotShadowMapUniforms = getArrayUniformHandles<kMaxSpotLights>("uSpotShadowMaps");
+
+      bindShadowMaps(sceneRenderInfo.directionalLights, kDirectionalShadowMapUniforms, context, dummyShadowMap);
+      bindShadowMaps(sceneRenderInfo.pointLights, kPointShadowMapUniforms, context, dummyShadowCubeMap);
+      bindShadowMaps(sceneRenderInfo.spotLights, kSpotShadowMapUniforms, context, dummyShadowMap);
    }
 
    ViewInfo getShadowViewInfo(const DirectionalLightComponent& directionalLight, const CameraComponent& camera)
@@ -296,7 +278,7 @@ namespace
       glm::vec3 clipBoundsMax = clipBounds.getMax();
       glm::mat4 viewToClip = glm::ortho(clipBoundsMin.x, clipBoundsMax.x, clipBoundsMin.y, clipBoundsMax.y, clipBoundsMin.z, clipBoundsMax.z);
 
-      Transform lightTransform = directionalLight.getAbsoluteTransform();
+      const Transform& lightTransform = directionalLight.getAbsoluteTransform();
       glm::vec3 lightDirection = lightTransform.transformVector(MathUtils::kForwardVector);
       glm::mat4 worldToView = glm::lookAt(lightTransform.position, lightTransform.position + lightDirection, MathUtils::kUpVector);
 
@@ -371,7 +353,7 @@ namespace
       float zFar = spotLight.getScaledRadius();
       glm::mat4 viewToClip = glm::perspective(fovY, aspectRatio, zNear, zFar);
 
-      Transform lightTransform = spotLight.getAbsoluteTransform();
+      const Transform& lightTransform = spotLight.getAbsoluteTransform();
       glm::vec3 viewTarget = lightTransform.transformPosition(MathUtils::kForwardVector);
       glm::mat4 worldToView = glm::lookAt(lightTransform.position, viewTarget, MathUtils::kUpVector);
 
@@ -380,6 +362,598 @@ namespace
       return viewInfo;
    }
 
+   struct CandidateModel
+   {
+      const ModelComponent* component = nullptr;
+      const Model* model = nullptr; // The selected LOD
+      std::size_t lod = 0;
+      std::size_t firstBoundsIndex = 0;
+      std::size_t firstSectionIndex = 0; // Counts the sections of all candidates, whether they have packed bounds or not
+      bool fullyInside = false;
+   };
+
+   // Temporary storage for a single cull. Each thread keeps its own, and reuses it between frames so that culling doesn't
+   // need to allocate once the buffers have grown large enough.
+   struct CullScratch
+   {
+      std::vector<CandidateModel> candidates;
+      PackedBounds sectionBounds;
+      std::vector<uint64_t> sectionVisibility;
+      std::vector<uint64_t> sectionOcclusion;
+      std::vector<uint64_t> sectionTooSmall;
+      std::vector<uint8_t> sectionFaceMasks;
+      std::size_t numSections = 0;
+
+      void clear()
+      {
+         candidates.clear();
+         sectionBounds.clear();
+         sectionVisibility.clear();
+         sectionOcclusion.clear();
+         sectionTooSmall.clear();
+         sectionFaceMasks.clear();
+         numSections = 0;
+      }
+
+      // Indexed by candidate section
+      bool isSectionTooSmall(std::size_t sectionIndex) const
+      {
+         return sectionIndex / 64 < sectionTooSmall.size() && FrustumCulling::isVisible(sectionTooSmall, sectionIndex);
+      }
+
+      void markSectionTooSmall(std::size_t sectionIndex)
+      {
+         if (sectionIndex / 64 >= sectionTooSmall.size())
+         {
+            sectionTooSmall.resize(sectionIndex / 64 + 1, 0);
+         }
+         sectionTooSmall[sectionIndex / 64] |= uint64_t(1) << (sectionIndex % 64);
+      }
+   };
+
+   enum class SectionSortMode
+   {
+      // Shader permutation, then material, then mesh, then front-to-back
+      Opaque,
+
+      // Mesh, then front-to-back (the depth only program doesn't depend on the material)
+      DepthOnly,
+
+      // Back-to-front
+      Translucent
+   };
+
+   // Either a regular view cull, or a point light cull (which handles all six faces at once)
+   struct CullJob
+   {
+      const ViewInfo* viewInfo = nullptr;
+      FrameVector<ModelRenderInfo>* culledModels = nullptr;
+      FrameVector<SectionRenderInfo>* opaqueSections = nullptr;
+      FrameVector<SectionRenderInfo>* translucentSections = nullptr;
+      PointLightRenderInfo* pointLightRenderInfo = nullptr;
+      OcclusionBuffer* occlusionBuffer = nullptr;
+      SectionSortMode opaqueSortMode = SectionSortMode::DepthOnly;
+
+      // Set for views that are lit in a forward pass, to limit each model to the lights that can reach it
+      const SceneRenderInfo* litSceneRenderInfo = nullptr;
+
+      // Only set for the main view, since the LOD history is kept per model (not per view)
+      bool useLodHysteresis = false;
+   };
+
+   CullScratch& getCullScratch()
+   {
+      thread_local CullScratch cullScratch;
+
+      cullScratch.clear();
+      return cullScratch;
+   }
+
+   // Adds the model if any of its sections pass the visibility test
+   template<typename SectionVisibleFunc>
+   void addModelRenderInfo(const CandidateModel& candidate, FrameVector<ModelRenderInfo>& models, SectionVisibleFunc&& isSectionVisible)
+   {
+      const Model& model = *candidate.model;
+      bool anySectionVisible = false;
+
+      ModelRenderInfo modelRenderInfo;
+      modelRenderInfo.model = &model;
+      modelRenderInfo.component = candidate.component;
+      modelRenderInfo.lod = static_cast<uint32_t>(candidate.lod);
+
+      // Single section models don't need a mask, since they are only added if visible
+      std::size_t numMeshSections = model.getNumMeshSections();
+      if (numMeshSections > 1)
+      {
+         modelRenderInfo.visibilityMask.reset(numMeshSections, false, models.get_allocator().getFrameAllocator());
+      }
+
+      for (std::size_t i = 0; i < numMeshSections; ++i)
+      {
+         bool visible = isSectionVisible(i);
+
+         if (numMeshSections > 1)
+         {
+            modelRenderInfo.visibilityMask.set(i, visible);
+         }
+
+         anySectionVisible |= visible;
+      }
+
+      if (anySectionVisible)
+      {
+         models.push_back(std::move(modelRenderInfo));
+      }
+   }
+
+   bool isPerspective(const ViewInfo& viewInfo)
+   {
+      return viewInfo.getViewToClip()[3][3] == 0.0f;
+   }
+
+   float calcViewDistance(const ViewInfo& viewInfo, const glm::vec3& worldPosition)
+   {
+      return glm::length(glm::vec3(viewInfo.getWorldToView() * glm::vec4(worldPosition, 1.0f)));
+   }
+
+   // Projected diameter of the bounds, as a fraction of the view's height
+   float calcScreenSize(const ViewInfo& viewInfo, const Bounds& worldBounds)
+   {
+      float projectedRadius = worldBounds.radius * viewInfo.getViewToClip()[1][1];
+
+      // Orthographic projections don't shrink with distance
+      if (!isPerspective(viewInfo))
+      {
+         return projectedRadius;
+      }
+
+      return projectedRadius / glm::max(calcViewDistance(viewInfo, worldBounds.center), kMinScreenSizeDistance);
+   }
+
+   std::size_t selectLod(const ModelComponent& modelComponent, const ViewInfo& viewInfo, float screenSize, bool useHysteresis)
+   {
+      std::size_t numLods = modelComponent.getNumLods();
+      if (numLods == 1)
+      {
+         return 0;
+      }
+
+      std::size_t lod = modelComponent.selectLod(screenSize, useHysteresis);
+      int biasedLod = static_cast<int>(lod) + viewInfo.getLodBias();
+      return static_cast<std::size_t>(glm::clamp(biasedLod, 0, static_cast<int>(numLods) - 1));
+   }
+
+   // Models beyond their max draw distance or below the view's min screen size are skipped outright, and sections below
+   // the min screen size are flagged in the scratch. LODs are picked for the given view (only the main view uses
+   // hysteresis).
+   template<typename OverlapFunc>
+   void gatherCandidateModels(const Scene& scene, OverlapFunc&& overlapFunc, bool testFullyInside, const ViewInfo& viewInfo, bool useLodHysteresis, CullScratch& scratch)
+   {
+      const ViewCullSettings& cullSettings = viewInfo.getCullSettings();
+
+      // The origin of an orthographic view (e.g. a directional light's shadow view) is arbitrary, so distance isn't
+      // meaningful there
+      bool testDrawDistance = isPerspective(viewInfo);
+
+      scene.getModelBoundingVolumeHierarchy().query(overlapFunc, [testFullyInside, &viewInfo, &cullSettings, testDrawDistance, useLodHysteresis, &scratch](const ModelComponent* modelComponent, bool fullyInside)
+      {
+         ASSERT(modelComponent);
+
+         const Bounds& worldBounds = modelComponent->getWorldBounds();
+         float maxDrawDistance = modelComponent->getMaxDrawDistance() * cullSettings.drawDistanceScale;
+         if (testDrawDistance && maxDrawDistance > 0.0f && calcViewDistance(viewInfo, worldBounds.center) - worldBounds.radius > maxDrawDistance)
+         {
+            return;
+         }
+
+         float screenSize = calcScreenSize(viewInfo, worldBounds);
+         if (screenSize < cullSettings.minScreenSize)
+         {
+            return;
+         }
+
+         std::size_t lod = selectLod(*modelComponent, viewInfo, screenSize, useLodHysteresis);
+         const Model& model = modelComponent->getLodModel(lod);
+         if (!model.getMesh())
+         {
+            return;
+         }
+
+         CandidateModel candidate;
+         candidate.component = modelComponent;
+         candidate.model = &model;
+         candidate.lod = lod;
+         candidate.firstBoundsIndex = scratch.sectionBounds.size();
+         candidate.firstSectionIndex = scratch.numSections;
+         candidate.fullyInside = fullyInside;
+
+         gsl::span<const Bounds> worldSectionBounds = modelComponent->getWorldSectionBounds(lod);
+         scratch.numSections += worldSectionBounds.size();
+
+         // Single section models were already tested as a whole
+         if (cullSettings.minScreenSize > 0.0f && worldSectionBounds.size() > 1)
+         {
+            for (std::size_t i = 0; i < worldSectionBounds.size(); ++i)
+            {
+               if (calcScreenSize(viewInfo, worldSectionBounds[i]) < cullSettings.minScreenSize)
+               {
+                  scratch.markSectionTooSmall(candidate.firstSectionIndex + i);
+               }
+            }
+         }
+
+         // If the whole model is inside the volume, there is usually no need to test each section
+         if (!fullyInside || testFullyInside)
+         {
+            for (const Bounds& sectionBounds : worldSectionBounds)
+            {
+               scratch.sectionBounds.add(sectionBounds);
+            }
+         }
+
+         scratch.candidates.push_back(candidate);
+      });
+   }
+
+   // Rasterizes the visible sections of all occluders, and then tests every visible section against the result
+   void applyOcclusionCulling(const std::vector<CandidateModel>& candidates, std::size_t numSections, const std::vector<uint64_t>& sectionVisibility, const ViewInfo& viewInfo, OcclusionBuffer& occlusionBuffer, std::vector<uint64_t>& sectionOcclusion)
+   {
+      occlusionBuffer.reset(viewInfo.getWorldToClip());
+
+      for (const CandidateModel& candidate : candidates)
+      {
+         if (candidate.component->isOccluder())
+         {
+            const Model& model = *candidate.model;
+            for (std::size_t i = 0; i < model.getNumMeshSections(); ++i)
+            {
+               if (candidate.fullyInside || FrustumCulling::isVisible(sectionVisibility, candidate.firstBoundsIndex + i))
+               {
+                  occlusionBuffer.rasterizeOccluder(model.getMeshSection(i).getBounds(), candidate.component->getLocalToWorldMatrix());
+               }
+            }
+         }
+      }
+
+      if (!occlusionBuffer.hasOccluders())
+      {
+         return;
+      }
+
+      // Bits are set for occluded sections (indexed per candidate section, since fully inside candidates don't have
+      // packed bounds)
+      sectionOcclusion.assign((numSections + 63) / 64, 0);
+
+      for (const CandidateModel& candidate : candidates)
+      {
+         gsl::span<const Bounds> worldSectionBounds = candidate.component->getWorldSectionBounds(candidate.lod);
+         for (std::size_t i = 0; i < worldSectionBounds.size(); ++i)
+         {
+            std::size_t sectionIndex = candidate.firstSectionIndex + i;
+            bool inFrustum = candidate.fullyInside || FrustumCulling::isVisible(sectionVisibility, candidate.firstBoundsIndex + i);
+            if (inFrustum && occlusionBuffer.isOccluded(worldSectionBounds[i]))
+            {
+               sectionOcclusion[sectionIndex / 64] |= uint64_t(1) << (sectionIndex % 64);
+            }
+         }
+      }
+   }
+
+   void cullModels(const Scene& scene, const ViewInfo& viewInfo, bool useLodHysteresis, OcclusionBuffer* occlusionBuffer, FrameVector<ModelRenderInfo>& culledModels)
+   {
+      FrustumPlanes frustumPlanes = FrustumCulling::computePlanes(viewInfo.getWorldToClip());
+
+      // Gather the bounds of all sections that need testing, so that they can be culled in batches
+      CullScratch& scratch = getCullScratch();
+      const std::vector<CandidateModel>& candidates = scratch.candidates;
+      const PackedBounds& sectionBounds = scratch.sectionBounds;
+
+      auto frustumOverlap = [&frustumPlanes](const glm::vec3& min, const glm::vec3& max)
+      {
+         return FrustumCulling::classifyBox(min, max, frustumPlanes);
+      };
+      gatherCandidateModels(scene, frustumOverlap, false, viewInfo, useLodHysteresis, scratch);
+
+      std::vector<uint64_t>& sectionVisibility = scratch.sectionVisibility;
+      FrustumCulling::cullPackedBounds(sectionBounds, frustumPlanes, sectionVisibility);
+
+      std::vector<uint64_t>& sectionOcclusion = scratch.sectionOcclusion;
+      if (occlusionBuffer)
+      {
+         applyOcclusionCulling(candidates, scratch.numSections, sectionVisibility, viewInfo, *occlusionBuffer, sectionOcclusion);
+      }
+
+      culledModels.reserve(candidates.size());
+      for (const CandidateModel& candidate : candidates)
+      {
+         addModelRenderInfo(candidate, culledModels, [&candidate, &scratch, &sectionVisibility, &sectionOcclusion](std::size_t section)
+         {
+            std::size_t sectionIndex = candidate.firstSectionIndex + section;
+            if (scratch.isSectionTooSmall(sectionIndex))
+            {
+               return false;
+            }
+
+            if (!sectionOcclusion.empty() && FrustumCulling::isVisible(sectionOcclusion, sectionIndex))
+            {
+               return false;
+            }
+
+            return candidate.fullyInside || FrustumCulling::isVisible(sectionVisibility, candidate.firstBoundsIndex + section);
+         });
+      }
+   }
+
+   // Uses the scene's light hierarchy, so the cost per model doesn't grow with the total number of lights
+   void calcLightMasks(const Scene& scene, const SceneRenderInfo& sceneRenderInfo, FrameVector<ModelRenderInfo>& models)
+   {
+      std::size_t numPointLights = std::min<std::size_t>(sceneRenderInfo.pointLights.size(), kMaxPointLights);
+      std::size_t numSpotLights = std::min<std::size_t>(sceneRenderInfo.spotLights.size(), kMaxSpotLights);
+
+      for (ModelRenderInfo& modelRenderInfo : models)
+      {
+         modelRenderInfo.pointLightMask = 0;
+         modelRenderInfo.spotLightMask = 0;
+
+         if (numPointLights == 0 && numSpotLights == 0)
+         {
+            continue;
+         }
+
+         scene.forEachLightAffecting(modelRenderInfo.component->getWorldBounds(), [&sceneRenderInfo, &modelRenderInfo, numPointLights, numSpotLights](const LightComponent* light)
+         {
+            // Only the lights that are bound to the forward programs matter, and there are few enough of those to search
+            for (std::size_t i = 0; i < numPointLights; ++i)
+            {
+               if (sceneRenderInfo.pointLights[i].component == light)
+               {
+                  modelRenderInfo.pointLightMask |= 1u << i;
+                  return;
+               }
+            }
+
+            for (std::size_t i = 0; i < numSpotLights; ++i)
+            {
+               if (sceneRenderInfo.spotLights[i].component == light)
+               {
+                  modelRenderInfo.spotLightMask |= 1u << i;
+                  return;
+               }
+            }
+         });
+      }
+   }
+
+   int getMaterialPermutationIndex(const Material& material)
+   {
+      return material.hasCommonParameter(CommonMaterialParameter::DiffuseTexture) * 0b001
+         + material.hasCommonParameter(CommonMaterialParameter::SpecularTexture) * 0b010
+         + material.hasCommonParameter(CommonMaterialParameter::NormalTexture) * 0b100;
+   }
+
+   // Only used for grouping, so a hash of the address is enough (a collision just interleaves two groups)
+   uint64_t getPointerSortKey(const void* pointer, int numBits)
+   {
+      uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer));
+      return (address * 0x9E3779B97F4A7C15ull) >> (64 - numBits);
+   }
+
+   // Non-negative floats have the same ordering as their bit patterns
+   uint32_t getDepthSortKey(float depth)
+   {
+      float clampedDepth = glm::max(depth, 0.0f);
+
+      uint32_t bits = 0;
+      std::memcpy(&bits, &clampedDepth, sizeof(bits));
+      return bits;
+   }
+
+   uint64_t calcSectionSortKey(SectionSortMode sortMode, const Material& material, const MeshSection& section, float depth)
+   {
+      uint64_t depthKey = getDepthSortKey(depth);
+
+      switch (sortMode)
+      {
+      case SectionSortMode::Opaque:
+         // 4 bits of permutation, 20 of material, 16 of mesh, and the top 24 bits of the depth (its sign bit is always 0)
+         return (static_cast<uint64_t>(getMaterialPermutationIndex(material)) << 60)
+            | (getPointerSortKey(&material, 20) << 40)
+            | (getPointerSortKey(&section, 16) << 24)
+            | (depthKey >> 8);
+      case SectionSortMode::DepthOnly:
+         return (getPointerSortKey(&section, 16) << 32) | depthKey;
+      case SectionSortMode::Translucent:
+         return 0xFFFFFFFFull - depthKey;
+      default:
+         ASSERT(false);
+         return 0;
+      }
+   }
+
+   // Builds the list of visible sections with the given blend mode, and sorts them for the pass that will draw them
+   void buildSectionRenderInfo(const FrameVector<ModelRenderInfo>& models, const ViewInfo& viewInfo, BlendMode blendMode, SectionSortMode sortMode, FrameVector<SectionRenderInfo>& sections)
+   {
+      const glm::mat4& worldToView = viewInfo.getWorldToView();
+
+      for (std::size_t modelIndex = 0; modelIndex < models.size(); ++modelIndex)
+      {
+         const ModelRenderInfo& modelRenderInfo = models[modelIndex];
+         ASSERT(modelRenderInfo.model);
+
+         for (std::size_t i = 0; i < modelRenderInfo.model->getNumMeshSections(); ++i)
+         {
+            const Material& material = modelRenderInfo.model->getMaterial(i);
+            if (!modelRenderInfo.isSectionVisible(i) || material.getBlendMode() != blendMode)
+            {
+               continue;
+            }
+
+            const MeshSection& section = modelRenderInfo.model->getMeshSection(i);
+
+            // Views look down -z
+            const glm::vec3& worldCenter = modelRenderInfo.component->getWorldSectionBounds(modelRenderInfo.lod)[i].center;
+            float depth = -(worldToView * glm::vec4(worldCenter, 1.0f)).z;
+
+            SectionRenderInfo sectionRenderInfo;
+            sectionRenderInfo.sortKey = calcSectionSortKey(sortMode, material, section, depth);
+            sectionRenderInfo.modelIndex = static_cast<uint32_t>(modelIndex);
+            sectionRenderInfo.sectionIndex = static_cast<uint32_t>(i);
+            sections.push_back(sectionRenderInfo);
+         }
+      }
+
+      thread_local std::vector<SectionRenderInfo> sortScratch;
+      sortScratch.resize(sections.size());
+      RadixSort::sort(sections.data(), sortScratch.data(), sections.size(), [](const SectionRenderInfo& sectionRenderInfo)
+      {
+         return sectionRenderInfo.sortKey;
+      });
+   }
+
+   // Gathers all casters within the light's radius in a single pass, and then assigns each of them to the cube faces
+   // that they touch
+   void cullPointLightShadowCasters(const Scene& scene, PointLightRenderInfo& pointLightRenderInfo)
+   {
+      const glm::vec3& lightPosition = pointLightRenderInfo.component->getAbsoluteTransform().position;
+      float radius = pointLightRenderInfo.farPlane;
+
+      CullScratch& scratch = getCullScratch();
+      const std::vector<CandidateModel>& candidates = scratch.candidates;
+      const PackedBounds& sectionBounds = scratch.sectionBounds;
+
+      auto sphereOverlap = [&lightPosition, radius](const glm::vec3& min, const glm::vec3& max)
+      {
+         return FrustumCulling::classifyBoxSphere(min, max, lightPosition, radius);
+      };
+      // All faces share the same origin and projection, so any of them can be used for distance and screen size
+      gatherCandidateModels(scene, sphereOverlap, true, pointLightRenderInfo.shadowViewInfo[0], false, scratch);
+
+      // One bit per face for each section
+      std::vector<uint8_t>& sectionFaceMasks = scratch.sectionFaceMasks;
+      sectionFaceMasks.assign(sectionBounds.size(), 0);
+      std::vector<uint64_t>& sectionVisibility = scratch.sectionVisibility;
+      for (std::size_t face = 0; face < pointLightRenderInfo.shadowViewInfo.size(); ++face)
+      {
+         FrustumPlanes facePlanes = FrustumCulling::computePlanes(pointLightRenderInfo.shadowViewInfo[face].getWorldToClip());
+         FrustumCulling::cullPackedBounds(sectionBounds, facePlanes, sectionVisibility);
+
+         for (std::size_t i = 0; i < sectionFaceMasks.size(); ++i)
+         {
+            if (FrustumCulling::isVisible(sectionVisibility, i))
+            {
+               sectionFaceMasks[i] |= 1 << face;
+            }
+         }
+      }
+
+      for (const CandidateModel& candidate : candidates)
+      {
+         uint8_t modelFaceMask = 0;
+         for (std::size_t i = 0; i < candidate.model->getNumMeshSections(); ++i)
+         {
+            if (scratch.isSectionTooSmall(candidate.firstSectionIndex + i))
+            {
+               sectionFaceMasks[candidate.firstBoundsIndex + i] = 0;
+            }
+
+            modelFaceMask |= sectionFaceMasks[candidate.firstBoundsIndex + i];
+         }
+
+         for (std::size_t face = 0; face < pointLightRenderInfo.shadowModelRenderInfo.size(); ++face)
+         {
+            if (modelFaceMask & (1 << face))
+            {
+               addModelRenderInfo(candidate, pointLightRenderInfo.shadowModelRenderInfo[face], [&candidate, &sectionFaceMasks, face](std::size_t section)
+               {
+                  return (sectionFaceMasks[candidate.firstBoundsIndex + section] & (1 << face)) != 0;
+               });
+            }
+         }
+      }
+
+      for (std::size_t face = 0; face < pointLightRenderInfo.shadowModelRenderInfo.size(); ++face)
+      {
+         buildSectionRenderInfo(pointLightRenderInfo.shadowModelRenderInfo[face], pointLightRenderInfo.shadowViewInfo[face], BlendMode::Opaque, SectionSortMode::DepthOnly, pointLightRenderInfo.shadowSectionRenderInfo[face]);
+      }
+   }
+
+   uint64_t hashCombine(uint64_t seed, uint64_t value)
+   {
+      return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+   }
+
+   uint64_t hashMatrix(const glm::mat4& matrix)
+   {
+      uint64_t hash = 0;
+      for (int column = 0; column < 4; ++column)
+      {
+         for (int row = 0; row < 4; ++row)
+         {
+            uint32_t bits = 0;
+            std::memcpy(&bits, &matrix[column][row], sizeof(bits));
+            hash = hashCombine(hash, bits);
+         }
+      }
+
+      return hash;
+   }
+
+   // Adds everything that a shadow view's depth depends on to the signature. Returns false if any caster isn't static, in
+   // which case the shadow map shouldn't be cached.
+   bool addShadowViewSignature(const ViewInfo& viewInfo, const FrameVector<ModelRenderInfo>& casters, uint64_t& signature)
+   {
+      // Summed, so that the signature doesn't depend on the (arbitrary) order that casters were gathered in
+      uint64_t castersHash = 0;
+      for (const ModelRenderInfo& caster : casters)
+      {
+         ASSERT(caster.component);
+         if (!caster.component->isStatic())
+         {
+            return false;
+         }
+
+         // Revisions are unique across all models, so a new model in a destroyed caster's memory never matches it
+         castersHash += hashCombine(caster.component->getRenderDataRevision(), caster.lod);
+      }
+
+      signature = hashCombine(signature, hashMatrix(viewInfo.getWorldToClip()));
+      signature = hashCombine(signature, castersHash);
+      return true;
+   }
+
+   bool calcShadowMapSignature(const DirectionalLightRenderInfo& directionalLightRenderInfo, uint64_t& signature)
+   {
+      signature = 0;
+      return directionalLightRenderInfo.component->getMobility() != Mobility::Movable
+         && addShadowViewSignature(directionalLightRenderInfo.shadowViewInfo, directionalLightRenderInfo.shadowModelRenderInfo, signature);
+   }
+
+   bool calcShadowMapSignature(const PointLightRenderInfo& pointLightRenderInfo, uint64_t& signature)
+   {
+      signature = 0;
+      if (pointLightRenderInfo.component->getMobility() == Mobility::Movable)
+      {
+         return false;
+      }
+
+      for (std::size_t face = 0; face < pointLightRenderInfo.shadowViewInfo.size(); ++face)
+      {
+         if (!addShadowViewSignature(pointLightRenderInfo.shadowViewInfo[face], pointLightRenderInfo.shadowModelRenderInfo[face], signature))
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   bool calcShadowMapSignature(const SpotLightRenderInfo& spotLightRenderInfo, uint64_t& signature)
+   {
+      signature = 0;
+      return spotLightRenderInfo.component->getMobility() != Mobility::Movable
+         && addShadowViewSignature(spotLightRenderInfo.shadowViewInfo, spotLightRenderInfo.shadowModelRenderInfo, signature);
+   }
+
    void prepareShadowMap(Texture& shadowMap)
    {
       shadowMap.bind();
@@ -410,7 +984,7 @@ DirectionalLightUniformData DirectionalLightRenderInfo::getUniformData() const
 
    DirectionalLightUniformData uniformData;
 
-   Transform transform = component->getAbsoluteTransform();
+   const Transform& transform = component->getAbsoluteTransform();
 
    uniformData.color = component->getColor();
    uniformData.direction = transform.rotateVector(MathUtils::kForwardVector);
@@ -429,7 +1003,7 @@ PointLightUniformData PointLightRenderInfo::getUniformData() const
 
    PointLightUniformData uniformData;
 
-   Transform transform = component->getAbsoluteTransform();
+   const Transform& transform = component->getAbsoluteTransform();
    float radiusScale = glm::max(transform.scale.x, glm::max(transform.scale.y, transform.scale.z));
 
    uniformData.color = component->getColor();
@@ -450,7 +1024,7 @@ SpotLightUniformData SpotLightRenderInfo::getUniformData() const
 
    SpotLightUniformData uniformData;
 
-   Transform transform = component->getAbsoluteTransform();
+   const Transform& transform = component->getAbsoluteTransform();
    float radiusScale = glm::max(transform.scale.x, glm::max(transform.scale.y, transform.scale.z));
 
    uniformData.color = component->getColor();
@@ -476,6 +1050,9 @@ SceneRenderer::SceneRenderer(const SPtr<ResourceManager>& inResourceManager, boo
 {
    ASSERT(resourceManager);
 
+   viewCullSettings.minScreenSize = kDefaultMinScreenSize;
+   shadowCullSettings.minScreenSize = kDefaultMinScreenSize;
+
    {
       shadowMapPool.bindOnResourceCreated([](Framebuffer& shadowMapFramebuffer)
       {
@@ -497,6 +1074,15 @@ SceneRenderer::SceneRenderer(const SPtr<ResourceManager>& inResourceManager, boo
       viewUniformBuffer->setLabel("View Uniform Buffer");
    }
 
+   {
+      lightUniformBuffer = std::make_shared<UniformBufferObject>("Lights");
+
+      LightBlockData lightBlockData = {};
+      lightUniformBuffer->setData(&lightBlockData, sizeof(lightBlockData));
+      lightUniformBuffer->bindTo(UniformBufferObjectIndex::Lights);
+      lightUniformBuffer->setLabel("Light Uniform Buffer");
+   }
+
    {
       Tex::Specification dummyShadowMapSpec;
       dummyShadowMapSpec.internalFormat = Tex::InternalFormat::Depth24Stencil8;
@@ -743,6 +1329,18 @@ void SceneRenderer::setFarPlaneDistance(float newFarPlaneDistance)
    farPlaneDistance = glm::max(newFarPlaneDistance, nearPlaneDistance + MathUtils::kKindaSmallNumber);
 }
 
+void SceneRenderer::setOcclusionCullingEnabled(bool enabled)
+{
+   if (enabled && !occlusionBuffer)
+   {
+      occlusionBuffer = std::make_unique<OcclusionBuffer>();
+   }
+   else if (!enabled)
+   {
+      occlusionBuffer = nullptr;
+   }
+}
+
 bool SceneRenderer::getViewInfo(const Scene& scene, ViewInfo& viewInfo) const
 {
    const CameraComponent* activeCamera = scene.getActiveCameraComponent();
@@ -751,7 +1349,7 @@ bool SceneRenderer::getViewInfo(const Scene& scene, ViewInfo& viewInfo) const
       return false;
    }
 
-   Transform cameraTransform = activeCamera->getAbsoluteTransform();
+   const Transform& cameraTransform = activeCamera->getAbsoluteTransform();
    glm::vec3 viewTarget = cameraTransform.transformPosition(MathUtils::kForwardVector);
    glm::mat4 worldToView = glm::lookAt(cameraTransform.position, viewTarget, MathUtils::kUpVector);
 
@@ -763,129 +1361,331 @@ bool SceneRenderer::getViewInfo(const Scene& scene, ViewInfo& viewInfo) const
    glm::mat4 viewToClip = glm::perspective(fovY, aspectRatio, zNear, zFar);
 
    viewInfo.init(worldToView, viewToClip);
+   viewInfo.setCullSettings(viewCullSettings);
 
    return true;
 }
 
-SceneRenderInfo SceneRenderer::calcSceneRenderInfo(const Scene& scene, const ViewInfo& viewInfo, bool includeLights) const
+SceneRenderInfo SceneRenderer::calcSceneRenderInfo(Scene& scene, const ViewInfo& viewInfo)
 {
-   SceneRenderInfo sceneRenderInfo;
-   sceneRenderInfo.viewInfo = viewInfo;
+   const CameraComponent* camera = scene.getActiveCameraComponent();
+   ASSERT(camera);
+
+   // The scene may have changed since it last ticked (e.g. from input), and culling reads it from several threads
+   scene.updateDerivedData();
 
-   std::array<glm::vec4, 6> frustumPlanes = computeFrustumPlanes(viewInfo.getWorldToClip());
+   // The previous frame's render info has been released by now
+   frameAllocator.reset();
+   instanceBuffer.beginFrame();
 
-   for (const ModelComponent* modelComponent : scene.getModelComponents())
+   SceneRenderInfo sceneRenderInfo;
+   sceneRenderInfo.viewInfo = viewInfo;
+   sceneRenderInfo.modelRenderInfo = makeFrameVector<ModelRenderInfo>(frameAllocator);
+   sceneRenderInfo.opaqueSectionRenderInfo = makeFrameVector<SectionRenderInfo>(frameAllocator);
+   sceneRenderInfo.translucentSectionRenderInfo = makeFrameVector<SectionRenderInfo>(frameAllocator);
+   sceneRenderInfo.directionalLights = makeFrameVector<DirectionalLightRenderInfo>(frameAllocator);
+   sceneRenderInfo.pointLights = makeFrameVector<PointLightRenderInfo>(frameAllocator);
+   sceneRenderInfo.spotLights = makeFrameVector<SpotLightRenderInfo>(frameAllocator);
+
+   FrustumPlanes frustumPlanes = FrustumCulling::computePlanes(viewInfo.getWorldToClip());
+
+   // Everything the light touches is our kingdom
+   sceneRenderInfo.directionalLights.reserve(scene.getDirectionalLightComponents().size());
+   for (DirectionalLightComponent* directionalLight : scene.getDirectionalLightComponents())
    {
-      ASSERT(modelComponent);
+      ASSERT(directionalLight);
 
-      bool anySectionVisible = false;
+      DirectionalLightRenderInfo directionalLightRenderInfo;
+      directionalLightRenderInfo.component = directionalLight;
+      directionalLightRenderInfo.shadowModelRenderInfo = makeFrameVector<ModelRenderInfo>(frameAllocator);
+      directionalLightRenderInfo.shadowSectionRenderInfo = makeFrameVector<SectionRenderInfo>(frameAllocator);
+      if (directionalLight->getCastShadows())
+      {
+         directionalLightRenderInfo.shadowViewInfo = getShadowViewInfo(*directionalLight, *camera);
+         directionalLightRenderInfo.shadowViewInfo.setLodBias(shadowLodBias);
+         directionalLightRenderInfo.shadowViewInfo.setCullSettings(shadowCullSettings);
+      }
+      sceneRenderInfo.directionalLights.push_back(std::move(directionalLightRenderInfo));
+   }
 
-      ModelRenderInfo modelRenderInfo;
-      modelRenderInfo.model = &modelComponent->getModel();
-      modelRenderInfo.localToWorld = modelComponent->getAbsoluteTransform();
+   // Lights are culled in batches from the scene's light data, and only the visible ones are read from their components
+   const LightSceneData& pointLightData = scene.getPointLightData();
+   FrustumCulling::cullPackedBounds(pointLightData.bounds, frustumPlanes, lightVisibility);
 
-      const Model& model = modelComponent->getModel();
-      if (const SPtr<Mesh>& mesh = model.getMesh())
+   sceneRenderInfo.pointLights.reserve(pointLightData.size());
+   for (std::size_t i = 0; i < pointLightData.size(); ++i)
+   {
+      if (FrustumCulling::isVisible(lightVisibility, i))
       {
-         for (std::size_t i = 0; i < model.getNumMeshSections(); ++i)
-         {
-            const MeshSection& section = model.getMeshSection(i);
-            const Bounds& localBounds = section.getBounds();
+         PointLightComponent* pointLight = scene.getPointLightComponents()[i];
+         ASSERT(pointLight);
 
-            Bounds worldBounds;
-            worldBounds.center = modelRenderInfo.localToWorld.transformPosition(localBounds.center);
-            worldBounds.extent = modelRenderInfo.localToWorld.transformVector(localBounds.extent);
-            worldBounds.radius = glm::max(glm::max(modelRenderInfo.localToWorld.scale.x, modelRenderInfo.localToWorld.scale.y), modelRenderInfo.localToWorld.scale.z) * localBounds.radius;
+         PointLightRenderInfo pointLightRenderInfo;
+         pointLightRenderInfo.component = pointLight;
+         for (std::size_t face = 0; face < pointLightRenderInfo.shadowModelRenderInfo.size(); ++face)
+         {
+            pointLightRenderInfo.shadowModelRenderInfo[face] = makeFrameVector<ModelRenderInfo>(frameAllocator);
+            pointLightRenderInfo.shadowSectionRenderInfo[face] = makeFrameVector<SectionRenderInfo>(frameAllocator);
+         }
+         if (pointLightData.castShadows[i])
+         {
+            glm::vec3 lightPosition(pointLightData.bounds.centerX[i], pointLightData.bounds.centerY[i], pointLightData.bounds.centerZ[i]);
 
-            bool visible = !frustumCull(worldBounds, frustumPlanes);
+            pointLightRenderInfo.nearPlane = kLightNearPlane;
+            pointLightRenderInfo.farPlane = pointLightData.bounds.radius[i];
 
-            if (model.getNumMeshSections() > 1)
+            glm::mat4 viewToClip = getCubeShadowViewToClip(pointLightRenderInfo.nearPlane, pointLightRenderInfo.farPlane);
+            for (std::size_t face = 0; face < pointLightRenderInfo.shadowViewInfo.size(); ++face)
             {
-               modelRenderInfo.visibilityMask.push_back(visible);
+               glm::mat4 worldToView = getCubeShadowWorldToView(lightPosition, static_cast<Fb::CubeFace>(face));
+               pointLightRenderInfo.shadowViewInfo[face].init(worldToView, viewToClip);
+               pointLightRenderInfo.shadowViewInfo[face].setLodBias(shadowLodBias);
+               pointLightRenderInfo.shadowViewInfo[face].setCullSettings(shadowCullSettings);
             }
-
-            anySectionVisible |= visible;
          }
+         sceneRenderInfo.pointLights.push_back(std::move(pointLightRenderInfo));
       }
+   }
 
-      if (anySectionVisible)
+   const LightSceneData& spotLightData = scene.getSpotLightData();
+   FrustumCulling::cullPackedBounds(spotLightData.bounds, frustumPlanes, lightVisibility);
+
+   sceneRenderInfo.spotLights.reserve(spotLightData.size());
+   for (std::size_t i = 0; i < spotLightData.size(); ++i)
+   {
+      if (FrustumCulling::isVisible(lightVisibility, i))
       {
-         sceneRenderInfo.modelRenderInfo.push_back(modelRenderInfo);
+         SpotLightComponent* spotLight = scene.getSpotLightComponents()[i];
+         ASSERT(spotLight);
+
+         SpotLightRenderInfo spotLightRenderInfo;
+         spotLightRenderInfo.component = spotLight;
+         spotLightRenderInfo.shadowModelRenderInfo = makeFrameVector<ModelRenderInfo>(frameAllocator);
+         spotLightRenderInfo.shadowSectionRenderInfo = makeFrameVector<SectionRenderInfo>(frameAllocator);
+         if (spotLightData.castShadows[i])
+         {
+            spotLightRenderInfo.shadowViewInfo = getShadowViewInfo(*spotLight);
+            spotLightRenderInfo.shadowViewInfo.setLodBias(shadowLodBias);
+            spotLightRenderInfo.shadowViewInfo.setCullSettings(shadowCullSettings);
+         }
+         sceneRenderInfo.spotLights.push_back(std::move(spotLightRenderInfo));
       }
    }
 
-   // Sort back-to-front
-   std::sort(sceneRenderInfo.modelRenderInfo.begin(), sceneRenderInfo.modelRenderInfo.end(),
-      [cameraPosition = viewInfo.getViewOrigin()](const ModelRenderInfo& first, const ModelRenderInfo& second)
-   {
-      return glm::distance2(first.localToWorld.position, cameraPosition) > glm::distance2(second.localToWorld.position, cameraPosition);
-   });
+   // Gather every view that needs culling, so that they can all be processed at once (before any GL submission)
+   FrameVector<CullJob> cullJobs = makeFrameVector<CullJob>(frameAllocator);
+   cullJobs.reserve(1 + sceneRenderInfo.directionalLights.size() + sceneRenderInfo.pointLights.size() + sceneRenderInfo.spotLights.size());
+
+   CullJob mainCullJob;
+   mainCullJob.viewInfo = &sceneRenderInfo.viewInfo;
+   mainCullJob.culledModels = &sceneRenderInfo.modelRenderInfo;
+   mainCullJob.opaqueSections = &sceneRenderInfo.opaqueSectionRenderInfo;
+   mainCullJob.translucentSections = &sceneRenderInfo.translucentSectionRenderInfo;
+   mainCullJob.occlusionBuffer = occlusionBuffer.get();
+   mainCullJob.opaqueSortMode = SectionSortMode::Opaque;
+   mainCullJob.litSceneRenderInfo = &sceneRenderInfo;
+   mainCullJob.useLodHysteresis = true;
+   cullJobs.push_back(mainCullJob);
 
-   if (includeLights)
+   for (DirectionalLightRenderInfo& directionalLightRenderInfo : sceneRenderInfo.directionalLights)
    {
-      // Everything the light touches is our kingdom
-      sceneRenderInfo.directionalLights.reserve(scene.getDirectionalLightComponents().size());
-      for (DirectionalLightComponent* directionalLight : scene.getDirectionalLightComponents())
+      if (directionalLightRenderInfo.component->getCastShadows())
       {
-         ASSERT(directionalLight);
-
-         DirectionalLightRenderInfo directionalLightRenderInfo;
-         directionalLightRenderInfo.component = directionalLight;
-         sceneRenderInfo.directionalLights.push_back(directionalLightRenderInfo);
+         CullJob cullJob;
+         cullJob.viewInfo = &directionalLightRenderInfo.shadowViewInfo;
+         cullJob.culledModels = &directionalLightRenderInfo.shadowModelRenderInfo;
+         cullJob.opaqueSections = &directionalLightRenderInfo.shadowSectionRenderInfo;
+         cullJobs.push_back(cullJob);
       }
-
-      for (PointLightComponent* pointLight : scene.getPointLightComponents())
+   }
+   for (PointLightRenderInfo& pointLightRenderInfo : sceneRenderInfo.pointLights)
+   {
+      if (pointLightRenderInfo.component->getCastShadows())
       {
-         ASSERT(pointLight);
+         CullJob cullJob;
+         cullJob.pointLightRenderInfo = &pointLightRenderInfo;
+         cullJobs.push_back(cullJob);
+      }
+   }
+   for (SpotLightRenderInfo& spotLightRenderInfo : sceneRenderInfo.spotLights)
+   {
+      if (spotLightRenderInfo.component->getCastShadows())
+      {
+         CullJob cullJob;
+         cullJob.viewInfo = &spotLightRenderInfo.shadowViewInfo;
+         cullJob.culledModels = &spotLightRenderInfo.shadowModelRenderInfo;
+         cullJob.opaqueSections = &spotLightRenderInfo.shadowSectionRenderInfo;
+         cullJobs.push_back(cullJob);
+      }
+   }
 
-         Transform localToWorld = pointLight->getAbsoluteTransform();
+   // Culling only reads from the scene, so each view can be processed on its own thread
+   scene.setTransformsReadOnly(true);
+   ThreadPool::instance().parallelFor(cullJobs.size(), [&scene, &cullJobs](std::size_t index)
+   {
+      const CullJob& cullJob = cullJobs[index];
+      if (cullJob.pointLightRenderInfo)
+      {
+         cullPointLightShadowCasters(scene, *cullJob.pointLightRenderInfo);
+      }
+      else
+      {
+         cullModels(scene, *cullJob.viewInfo, cullJob.useLodHysteresis, cullJob.occlusionBuffer, *cullJob.culledModels);
 
-         Bounds worldBounds;
-         worldBounds.center = localToWorld.position;
-         worldBounds.radius = pointLight->getScaledRadius();
-         worldBounds.extent = glm::vec3(worldBounds.radius);
+         if (cullJob.litSceneRenderInfo)
+         {
+            calcLightMasks(scene, *cullJob.litSceneRenderInfo, *cullJob.culledModels);
+         }
 
-         bool visible = !frustumCull(worldBounds, frustumPlanes);
-         if (visible)
+         // Sorting happens here too, so that the lists are ready to draw once all jobs are done
+         if (cullJob.opaqueSections)
+         {
+            buildSectionRenderInfo(*cullJob.culledModels, *cullJob.viewInfo, BlendMode::Opaque, cullJob.opaqueSortMode, *cullJob.opaqueSections);
+         }
+         if (cullJob.translucentSections)
          {
-            PointLightRenderInfo pointLightRenderInfo;
-            pointLightRenderInfo.component = pointLight;
-            sceneRenderInfo.pointLights.push_back(pointLightRenderInfo);
+            buildSectionRenderInfo(*cullJob.culledModels, *cullJob.viewInfo, BlendMode::Translucent, SectionSortMode::Translucent, *cullJob.translucentSections);
          }
       }
+   });
+   scene.setTransformsReadOnly(false);
+
+   return sceneRenderInfo;
+}
+
+void SceneRenderer::setView(const ViewInfo& viewInfo)
+{
+   viewUniformBuffer->updateData(calcViewUniforms(viewInfo));
+}
 
-      sceneRenderInfo.spotLights.reserve(scene.getSpotLightComponents().size());
-      for (SpotLightComponent* spotLight : scene.getSpotLightComponents())
+const std::vector<InstancedDrawBatch>& SceneRenderer::prepareInstancedDraws(const FrameVector<ModelRenderInfo>& models, const FrameVector<SectionRenderInfo>& sections, bool groupByMaterial)
+{
+   instances.clear();
+   instancedDraws.clear();
+   instancedDrawBatches.clear();
+
+   // Opaque and depth only sections are sorted so that all uses of a section end up next to each other. Translucent
+   // sections have to stay in depth order, so only neighbors are merged (instances are drawn in order, so this is safe).
+   for (const SectionRenderInfo& sectionRenderInfo : sections)
+   {
+      const ModelRenderInfo& modelRenderInfo = models[sectionRenderInfo.modelIndex];
+      ASSERT(modelRenderInfo.model && modelRenderInfo.component);
+
+      const MeshSection& section = modelRenderInfo.model->getMeshSection(sectionRenderInfo.sectionIndex);
+      const Material& material = modelRenderInfo.model->getMaterial(sectionRenderInfo.sectionIndex);
+
+      bool continuesDraw = !instancedDraws.empty() && instancedDraws.back().section == &section && (!groupByMaterial || instancedDraws.back().material == &material);
+      if (continuesDraw)
       {
-         ASSERT(spotLight);
+         ++instancedDraws.back().numInstances;
+      }
+      else
+      {
+         InstancedDraw instancedDraw;
+         instancedDraw.section = &section;
+         instancedDraw.material = &material;
+         instancedDraw.firstInstance = static_cast<uint32_t>(instances.size());
+         instancedDraw.numInstances = 1;
+         instancedDraws.push_back(instancedDraw);
+      }
+
+      InstanceData instance;
+      instance.localToWorld = modelRenderInfo.component->getLocalToWorldMatrix();
+      instance.localToNormal = glm::mat3(modelRenderInfo.component->getLocalToNormalMatrix());
+      instance.customData = glm::uvec2(modelRenderInfo.pointLightMask, modelRenderInfo.spotLightMask);
+      instances.push_back(instance);
+   }
 
-         Transform localToWorld = spotLight->getAbsoluteTransform();
+   instanceBuffer.setData(instances);
 
-         // Set the radius to half that of the light, and center the bounds on the center of the light (not the origin)
-         Bounds worldBounds;
-         worldBounds.radius = spotLight->getScaledRadius() * 0.5f;
-         worldBounds.extent = glm::vec3(worldBounds.radius);
-         worldBounds.center = localToWorld.position + localToWorld.rotateVector(MathUtils::kForwardVector) * worldBounds.radius;
+   for (uint32_t drawIndex = 0; drawIndex < instancedDraws.size(); ++drawIndex)
+   {
+      const InstancedDraw& instancedDraw = instancedDraws[drawIndex];
+
+      if (!instancedDrawBatches.empty())
+      {
+         InstancedDrawBatch& batch = instancedDrawBatches.back();
+         const InstancedDraw& firstDraw = instancedDraws[batch.firstDraw];
 
-         bool visible = !frustumCull(worldBounds, frustumPlanes);
-         if (visible)
+         bool sameState = firstDraw.section->getArena() == instancedDraw.section->getArena() && (!groupByMaterial || firstDraw.material == instancedDraw.material);
+         if (sameState)
          {
-            SpotLightRenderInfo spotLightRenderInfo;
-            spotLightRenderInfo.component = spotLight;
-            sceneRenderInfo.spotLights.push_back(spotLightRenderInfo);
+            ++batch.numDraws;
+            continue;
          }
       }
+
+      InstancedDrawBatch batch;
+      batch.material = instancedDraw.material;
+      batch.firstDraw = drawIndex;
+      batch.numDraws = 1;
+      instancedDrawBatches.push_back(batch);
+   }
+
+#if SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
+   indirectCommands.clear();
+   for (InstancedDrawBatch& batch : instancedDrawBatches)
+   {
+      if (batch.numDraws < 2 || !instancedDraws[batch.firstDraw].section->getArena())
+      {
+         continue;
+      }
+
+      batch.multiDraw = true;
+      batch.firstCommand = static_cast<uint32_t>(indirectCommands.size());
+
+      for (uint32_t drawIndex = batch.firstDraw; drawIndex < batch.firstDraw + batch.numDraws; ++drawIndex)
+      {
+         const InstancedDraw& instancedDraw = instancedDraws[drawIndex];
+         const GeometryArena::Allocation& allocation = instancedDraw.section->getArenaAllocation();
+
+         // Base instances offset the per instance attributes, so they don't need to be pointed at each draw's range
+         DrawElementsIndirectCommand command;
+         command.count = allocation.numIndices;
+         command.instanceCount = instancedDraw.numInstances;
+         command.firstIndex = allocation.firstIndex;
+         command.baseVertex = static_cast<GLint>(allocation.firstVertex);
+         command.baseInstance = instancedDraw.firstInstance;
+         indirectCommands.push_back(command);
+      }
    }
 
-   return sceneRenderInfo;
+   if (!indirectCommands.empty())
+   {
+      indirectBuffer.setData(BufferBindingTarget::DrawIndirect, indirectCommands.size() * sizeof(DrawElementsIndirectCommand), indirectCommands.data(), BufferUsage::StreamDraw);
+   }
+#endif // SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
+
+   return instancedDrawBatches;
 }
 
-void SceneRenderer::setView(const ViewInfo& viewInfo)
+void SceneRenderer::submitInstancedDraws(const DrawingContext& context, const InstancedDrawBatch& batch) const
 {
-   viewUniformBuffer->updateData(calcViewUniforms(viewInfo));
+#if SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
+   if (batch.multiDraw)
+   {
+      ASSERT(context.program);
+      context.program->commit();
+
+      instancedDraws[batch.firstDraw].section->getArena()->bind();
+      instanceBuffer.bindAttributes(0);
+
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer.getId());
+      const GLvoid* firstCommandOffset = reinterpret_cast<const GLvoid*>(static_cast<uintptr_t>(batch.firstCommand) * sizeof(DrawElementsIndirectCommand));
+      GraphicsContext::current().multiDrawElementsIndirect(PrimitiveMode::Triangles, IndexType::UnsignedInt, firstCommandOffset, batch.numDraws);
+
+      return;
+   }
+#endif // SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
+
+   for (uint32_t drawIndex = batch.firstDraw; drawIndex < batch.firstDraw + batch.numDraws; ++drawIndex)
+   {
+      const InstancedDraw& instancedDraw = instancedDraws[drawIndex];
+      instancedDraw.section->drawInstanced(context, instanceBuffer, instancedDraw.firstInstance, instancedDraw.numInstances);
+   }
 }
 
-void SceneRenderer::renderDepthPass(const SceneRenderInfo& sceneRenderInfo, Framebuffer& framebuffer)
+void SceneRenderer::renderDepthPass(const FrameVector<ModelRenderInfo>& models, const FrameVector<SectionRenderInfo>& sections, Framebuffer& framebuffer)
 {
    framebuffer.bind();
 
@@ -894,31 +1694,17 @@ void SceneRenderer::renderDepthPass(const SceneRenderInfo& sceneRenderInfo, Fram
 
    glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-   for (const ModelRenderInfo& modelRenderInfo : sceneRenderInfo.modelRenderInfo)
+   // Sections only contain opaque geometry, and every material uses the same program
+   for (const InstancedDrawBatch& batch : prepareInstancedDraws(models, sections, false))
    {
-      ASSERT(modelRenderInfo.model);
-
-      glm::mat4 localToWorld = modelRenderInfo.localToWorld.toMatrix();
-      depthOnlyProgram->setUniformValue(UniformNames::kLocalToWorld, localToWorld);
-
-      for (std::size_t i = 0; i < modelRenderInfo.model->getNumMeshSections(); ++i)
-      {
-         const MeshSection& section = modelRenderInfo.model->getMeshSection(i);
-         const Material& material = modelRenderInfo.model->getMaterial(i);
-
-         bool visible = i >= modelRenderInfo.visibilityMask.size() || modelRenderInfo.visibilityMask[i];
-         if (visible && material.getBlendMode() == BlendMode::Opaque)
-         {
-            DrawingContext context(depthOnlyProgram.get());
-            section.draw(context);
-         }
-      }
+      DrawingContext context(depthOnlyProgram.get());
+      submitInstancedDraws(context, batch);
    }
 }
 
 void SceneRenderer::renderPrePass(const SceneRenderInfo& sceneRenderInfo)
 {
-   renderDepthPass(sceneRenderInfo, prePassFramebuffer);
+   renderDepthPass(sceneRenderInfo.modelRenderInfo, sceneRenderInfo.opaqueSectionRenderInfo, prePassFramebuffer);
 }
 
 void SceneRenderer::setPrePassDepthAttachment(const SPtr<Texture>& depthAttachment)
@@ -956,119 +1742,109 @@ void SceneRenderer::setSSAOTextures(const SPtr<Texture>& depthTexture, const SPt
    ssaoMaterial.setParameter("uNormal", normalTexture);
 }
 
-SPtr<Framebuffer> SceneRenderer::renderShadowMap(const Scene& scene, const DirectionalLightComponent& directionalLight, ViewInfo& viewInfo)
+SPtr<Framebuffer> SceneRenderer::renderShadowMap(const DirectionalLightRenderInfo& directionalLightRenderInfo)
 {
    static const int kShadowMapRes = 2048;
 
-   ASSERT(directionalLight.getCastShadows());
-
-   const CameraComponent* camera = scene.getActiveCameraComponent();
-   if (!camera)
-   {
-      return nullptr;
-   }
-
-   viewInfo = getShadowViewInfo(directionalLight, *camera);
+   ASSERT(directionalLightRenderInfo.component && directionalLightRenderInfo.component->getCastShadows());
 
-   SceneRenderInfo shadowSceneRenderInfo = calcSceneRenderInfo(scene, viewInfo, false);
-   setView(viewInfo);
+   setView(directionalLightRenderInfo.shadowViewInfo);
 
    SPtr<Framebuffer> shadowFramebuffer = obtainShadowMap(kShadowMapRes, kShadowMapRes);
-   renderDepthPass(shadowSceneRenderInfo, *shadowFramebuffer);
+   renderDepthPass(directionalLightRenderInfo.shadowModelRenderInfo, directionalLightRenderInfo.shadowSectionRenderInfo, *shadowFramebuffer);
 
    return shadowFramebuffer;
 }
 
-SPtr<Framebuffer> SceneRenderer::renderShadowMap(const Scene& scene, const PointLightComponent& pointLight, float& nearPlane, float& farPlane)
+SPtr<Framebuffer> SceneRenderer::renderShadowMap(const PointLightRenderInfo& pointLightRenderInfo)
 {
    static const int kCubeShadowMapRes = 1024;
 
-   ASSERT(pointLight.getCastShadows());
-
-   nearPlane = kLightNearPlane;
-   farPlane = pointLight.getScaledRadius();
-
-   glm::vec3 lightPosition = pointLight.getAbsolutePosition();
-   glm::mat4 viewToClip = getCubeShadowViewToClip(nearPlane, farPlane);
+   ASSERT(pointLightRenderInfo.component && pointLightRenderInfo.component->getCastShadows());
 
    SPtr<Framebuffer> cubeShadowFramebuffer = obtainCubeShadowMap(kCubeShadowMapRes);
 
-   auto renderFaceDepthPass = [&](Fb::CubeFace face)
+   for (std::size_t face = 0; face < pointLightRenderInfo.shadowViewInfo.size(); ++face)
    {
-      glm::mat4 worldToView = getCubeShadowWorldToView(lightPosition, face);
-
-      ViewInfo viewInfo;
-      viewInfo.init(worldToView, viewToClip);
-
-      SceneRenderInfo sceneRenderInfo = calcSceneRenderInfo(scene, viewInfo, false);
-      setView(viewInfo);
+      setView(pointLightRenderInfo.shadowViewInfo[face]);
 
       cubeShadowFramebuffer->bind();
-      cubeShadowFramebuffer->setActiveFace(face);
-      renderDepthPass(sceneRenderInfo, *cubeShadowFramebuffer);
-   };
-
-   renderFaceDepthPass(Fb::CubeFace::Front);
-   renderFaceDepthPass(Fb::CubeFace::Back);
-   renderFaceDepthPass(Fb::CubeFace::Top);
-   renderFaceDepthPass(Fb::CubeFace::Bottom);
-   renderFaceDepthPass(Fb::CubeFace::Left);
-   renderFaceDepthPass(Fb::CubeFace::Right);
+      cubeShadowFramebuffer->setActiveFace(static_cast<Fb::CubeFace>(face));
+      renderDepthPass(pointLightRenderInfo.shadowModelRenderInfo[face], pointLightRenderInfo.shadowSectionRenderInfo[face], *cubeShadowFramebuffer);
+   }
 
    return cubeShadowFramebuffer;
 }
 
-SPtr<Framebuffer> SceneRenderer::renderShadowMap(const Scene& scene, const SpotLightComponent& spotLight, ViewInfo& viewInfo)
+SPtr<Framebuffer> SceneRenderer::renderShadowMap(const SpotLightRenderInfo& spotLightRenderInfo)
 {
    static const int kShadowMapRes = 1024;
 
-   ASSERT(spotLight.getCastShadows());
-
-   viewInfo = getShadowViewInfo(spotLight);
+   ASSERT(spotLightRenderInfo.component && spotLightRenderInfo.component->getCastShadows());
 
-   SceneRenderInfo shadowSceneRenderInfo = calcSceneRenderInfo(scene, viewInfo, false);
-   setView(viewInfo);
+   setView(spotLightRenderInfo.shadowViewInfo);
 
    SPtr<Framebuffer> shadowFramebuffer = obtainShadowMap(kShadowMapRes, kShadowMapRes);
-   renderDepthPass(shadowSceneRenderInfo, *shadowFramebuffer);
+   renderDepthPass(spotLightRenderInfo.shadowModelRenderInfo, spotLightRenderInfo.shadowSectionRenderInfo, *shadowFramebuffer);
 
    return shadowFramebuffer;
 }
 
-void SceneRenderer::renderShadowMaps(const Scene& scene, SceneRenderInfo& sceneRenderInfo)
+void SceneRenderer::renderShadowMaps(SceneRenderInfo& sceneRenderInfo)
 {
    bool anyShadowMapsRendered = false;
 
-   for (DirectionalLightRenderInfo& directionalLightRenderInfo : sceneRenderInfo.directionalLights)
+   // Only lights that cast shadows this frame keep their cached shadow maps
+   std::unordered_map<const LightComponent*, CachedShadowMap> previousShadowMaps = std::move(cachedShadowMaps);
+   cachedShadowMaps.clear();
+
+   // Non-movable lights with only static casters reuse their previous shadow map, as long as nothing it depends on changed
+   auto obtainRenderedShadowMap = [this, &previousShadowMaps, &anyShadowMapsRendered](const auto& lightRenderInfo)
    {
-      const DirectionalLightComponent* component = directionalLightRenderInfo.component;
+      const LightComponent* light = lightRenderInfo.component;
 
-      if (component->getCastShadows())
+      uint64_t signature = 0;
+      if (!calcShadowMapSignature(lightRenderInfo, signature))
       {
-         directionalLightRenderInfo.shadowMapFramebuffer = renderShadowMap(scene, *component, directionalLightRenderInfo.shadowViewInfo);
          anyShadowMapsRendered = true;
+         return renderShadowMap(lightRenderInfo);
+      }
+
+      auto location = previousShadowMaps.find(light);
+      if (location != previousShadowMaps.end() && location->second.signature == signature)
+      {
+         return cachedShadowMaps.emplace(light, std::move(location->second)).first->second.framebuffer;
+      }
+
+      anyShadowMapsRendered = true;
+
+      CachedShadowMap cachedShadowMap;
+      cachedShadowMap.framebuffer = renderShadowMap(lightRenderInfo);
+      cachedShadowMap.signature = signature;
+      return cachedShadowMaps.emplace(light, std::move(cachedShadowMap)).first->second.framebuffer;
+   };
+
+   for (DirectionalLightRenderInfo& directionalLightRenderInfo : sceneRenderInfo.directionalLights)
+   {
+      if (directionalLightRenderInfo.component->getCastShadows())
+      {
+         directionalLightRenderInfo.shadowMapFramebuffer = obtainRenderedShadowMap(directionalLightRenderInfo);
       }
    }
 
    for (PointLightRenderInfo& pointLightRenderInfo : sceneRenderInfo.pointLights)
    {
-      const PointLightComponent* component = pointLightRenderInfo.component;
-
-      if (component->getCastShadows())
+      if (pointLightRenderInfo.component->getCastShadows())
       {
-         pointLightRenderInfo.shadowMapFramebuffer = renderShadowMap(scene, *component, pointLightRenderInfo.nearPlane, pointLightRenderInfo.farPlane);
-         anyShadowMapsRendered = true;
+         pointLightRenderInfo.shadowMapFramebuffer = obtainRenderedShadowMap(pointLightRenderInfo);
       }
    }
 
    for (SpotLightRenderInfo& spotLightRenderInfo : sceneRenderInfo.spotLights)
    {
-      const SpotLightComponent* component = spotLightRenderInfo.component;
-
-      if (component->getCastShadows())
+      if (spotLightRenderInfo.component->getCastShadows())
       {
-         spotLightRenderInfo.shadowMapFramebuffer = renderShadowMap(scene, *component, spotLightRenderInfo.shadowViewInfo);
-         anyShadowMapsRendered = true;
+         spotLightRenderInfo.shadowMapFramebuffer = obtainRenderedShadowMap(spotLightRenderInfo);
       }
    }
 
@@ -1076,10 +1852,18 @@ void SceneRenderer::renderShadowMaps(const Scene& scene, SceneRenderInfo& sceneR
    {
       setView(sceneRenderInfo.viewInfo);
    }
+
+   // Every light's data (including whether it has a shadow map) is known at this point, so it can all be uploaded at once
+   updateLightUniformBuffer(sceneRenderInfo, {});
 }
 
 void SceneRenderer::renderTranslucencyPass(const SceneRenderInfo& sceneRenderInfo)
 {
+   if (sceneRenderInfo.translucentSectionRenderInfo.empty())
+   {
+      return;
+   }
+
    translucencyPassFramebuffer.bind();
 
    RasterizerState rasterizerState;
@@ -1092,33 +1876,14 @@ void SceneRenderer::renderTranslucencyPass(const SceneRenderInfo& sceneRenderInf
    std::array<DrawingContext, 8> contexts;
    populateForwardUniforms(sceneRenderInfo, contexts);
 
-   for (const ModelRenderInfo& modelRenderInfo : sceneRenderInfo.modelRenderInfo)
+   for (const InstancedDrawBatch& batch : prepareInstancedDraws(sceneRenderInfo.modelRenderInfo, sceneRenderInfo.translucentSectionRenderInfo, true))
    {
-      ASSERT(modelRenderInfo.model);
-
-      glm::mat4 localToWorld = modelRenderInfo.localToWorld.toMatrix();
-      glm::mat4 localToNormal = glm::transpose(glm::inverse(localToWorld));
-
-      for (std::size_t i = 0; i < modelRenderInfo.model->getNumMeshSections(); ++i)
-      {
-         const MeshSection& section = modelRenderInfo.model->getMeshSection(i);
-         const Material& material = modelRenderInfo.model->getMaterial(i);
-
-         bool visible = i >= modelRenderInfo.visibilityMask.size() || modelRenderInfo.visibilityMask[i];
-         if (visible && material.getBlendMode() == BlendMode::Translucent)
-         {
-            int permutationIndex = selectForwardPermutation(material);
-            DrawingContext& permutationContext = contexts[permutationIndex];
+      int permutationIndex = selectForwardPermutation(*batch.material);
 
-            permutationContext.program->setUniformValue(UniformNames::kLocalToWorld, localToWorld);
-            permutationContext.program->setUniformValue(UniformNames::kLocalToNormal, localToNormal, false);
-
-            DrawingContext localContext = permutationContext;
-            forwardMaterial.apply(localContext);
-            material.apply(localContext);
-            section.draw(localContext);
-         }
-      }
+      DrawingContext localContext = contexts[permutationIndex];
+      forwardMaterial.apply(localContext);
+      batch.material->apply(localContext);
+      submitInstancedDraws(localContext, batch);
    }
 }
 
@@ -1209,40 +1974,82 @@ void SceneRenderer::loadForwardProgramPermutations()
          shaderSpecification.definitions["WITH_SPECULAR_TEXTURE"] = i & 0b010 ? "1" : "0";
          shaderSpecification.definitions["WITH_NORMAL_TEXTURE"] = i & 0b100 ? "1" : "0";
 
-         shaderSpecification.definitions["MAX_DIRECTIONAL_LIGHTS"] = std::to_string(kMaxDirectionalLights);
-         shaderSpecification.definitions["MAX_POINT_LIGHTS"] = std::to_string(kMaxPointLights);
-         shaderSpecification.definitions["MAX_SPOT_LIGHTS"] = std::to_string(kMaxSpotLights);
+         addLightDefinitions(shaderSpecification);
       }
 
       forwardProgramPermutations[i] = getResourceManager().loadShaderProgram(shaderSpecifications);
       forwardProgramPermutations[i]->bindUniformBuffer(GraphicsContext::current().getFramebufferUniformBuffer());
       forwardProgramPermutations[i]->bindUniformBuffer(viewUniformBuffer);
+      forwardProgramPermutations[i]->bindUniformBuffer(lightUniformBuffer);
+      Material::bindConstantsBlock(*forwardProgramPermutations[i]);
    }
 }
 
 int SceneRenderer::selectForwardPermutation(const Material& material)
 {
-   int index = material.hasCommonParameter(CommonMaterialParameter::DiffuseTexture) * 0b001
-      + material.hasCommonParameter(CommonMaterialParameter::SpecularTexture) * 0b010
-      + material.hasCommonParameter(CommonMaterialParameter::NormalTexture) * 0b100;
-
-   return index;
+   return getMaterialPermutationIndex(material);
 }
 
 void SceneRenderer::populateForwardUniforms(const SceneRenderInfo& sceneRenderInfo, std::array<DrawingContext, 8>& contexts)
 {
    ASSERT(contexts.size() == forwardProgramPermutations.size());
 
+   // Forward shading reads the first lights of each type
+   if (lightUniformBufferFirstLights != std::array<int, 3>{})
+   {
+      updateLightUniformBuffer(sceneRenderInfo, {});
+   }
+
    int index = 0;
    for (SPtr<ShaderProgram>& forwardProgramPermutation : forwardProgramPermutations)
    {
       contexts[index].program = forwardProgramPermutation.get();
-      populateLightUniforms(sceneRenderInfo, contexts[index], dummyShadowMap, dummyShadowCubeMap);
+      bindForwardShadowMaps(sceneRenderInfo, contexts[index], dummyShadowMap, dummyShadowCubeMap);
 
       ++index;
    }
 }
 
+// static
+void SceneRenderer::addLightDefinitions(ShaderSpecification& shaderSpecification)
+{
+   shaderSpecification.definitions["MAX_DIRECTIONAL_LIGHTS"] = std::to_string(kMaxDirectionalLights);
+   shaderSpecification.definitions["MAX_POINT_LIGHTS"] = std::to_string(kMaxPointLights);
+   shaderSpecification.definitions["MAX_SPOT_LIGHTS"] = std::to_string(kMaxSpotLights);
+}
+
+int SceneRenderer::selectLightUniformIndex(const SceneRenderInfo& sceneRenderInfo, LightType type, int lightIndex)
+{
+   static const std::array<int, 3> kMaxLights = { static_cast<int>(kMaxDirectionalLights), static_cast<int>(kMaxPointLights), static_cast<int>(kMaxSpotLights) };
+
+   std::size_t typeIndex = static_cast<std::size_t>(type);
+   int firstLight = lightUniformBufferFirstLights[typeIndex];
+
+   if (lightIndex < firstLight || lightIndex >= firstLight + kMaxLights[typeIndex])
+   {
+      std::array<int, 3> firstLights = lightUniformBufferFirstLights;
+      firstLights[typeIndex] = lightIndex;
+      updateLightUniformBuffer(sceneRenderInfo, firstLights);
+
+      firstLight = lightIndex;
+   }
+
+   return lightIndex - firstLight;
+}
+
+void SceneRenderer::updateLightUniformBuffer(const SceneRenderInfo& sceneRenderInfo, const std::array<int, 3>& firstLights)
+{
+   LightBlockData lightBlockData;
+
+   lightBlockData.numDirectionalLights = packLights(sceneRenderInfo.directionalLights, firstLights[static_cast<std::size_t>(LightType::Directional)], lightBlockData.directionalLights);
+   lightBlockData.numPointLights = packLights(sceneRenderInfo.pointLights, firstLights[static_cast<std::size_t>(LightType::Point)], lightBlockData.pointLights);
+   lightBlockData.numSpotLights = packLights(sceneRenderInfo.spotLights, firstLights[static_cast<std::size_t>(LightType::Spot)], lightBlockData.spotLights);
+   lightBlockData.padding = 0;
+
+   lightUniformBuffer->updateData(&lightBlockData, sizeof(lightBlockData));
+   lightUniformBufferFirstLights = firstLights;
+}
+
 SPtr<Framebuffer> SceneRenderer::obtainShadowMap(int width, int height)
 {
    Fb::Specification shadowMapSpecification;
@@ -1,18 +1,29 @@
 #pragma once
 
 #include "Core/Assert.h"
+#include "Core/FrameAllocator.h"
+#include "Core/InlineBitset.h"
 #include "Core/Pointers.h"
 #include "Graphics/Framebuffer.h"
+#include "Graphics/GraphicsContext.h"
+#include "Graphics/GraphicsDefines.h"
+#include "Graphics/InstanceBuffer.h"
 #include "Graphics/Material.h"
 #include "Graphics/Mesh.h"
 #include "Graphics/ResourcePool.h"
 #include "Graphics/UniformBufferObject.h"
 #include "Math/Transform.h"
+#include "Scene/Rendering/OcclusionBuffer.h"
 
 #include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 class DirectionalLightComponent;
+class LightComponent;
 class Model;
 class ModelComponent;
 class PointLightComponent;
@@ -22,12 +33,16 @@ class ShaderProgram;
 class SpotLightComponent;
 class Texture;
 struct DrawingContext;
+struct ShaderSpecification;
 
-namespace UniformNames
+struct ViewCullSettings
 {
-   extern const char* kLocalToWorld;
-   extern const char* kLocalToNormal;
-}
+   // Models and sections whose projected diameter (as a fraction of the view's height) is smaller than this are culled
+   float minScreenSize = 0.0f;
+
+   // Scales the max draw distance of every model
+   float drawDistanceScale = 1.0f;
+};
 
 class ViewInfo
 {
@@ -59,17 +74,81 @@ public:
       return glm::vec3(-worldToView[3][0], -worldToView[3][1], -worldToView[3][2]);
    }
 
+   // Added to the LOD picked for every model in the view (positive values select coarser LODs)
+   int getLodBias() const
+   {
+      return lodBias;
+   }
+
+   void setLodBias(int newLodBias)
+   {
+      lodBias = newLodBias;
+   }
+
+   const ViewCullSettings& getCullSettings() const
+   {
+      return cullSettings;
+   }
+
+   void setCullSettings(const ViewCullSettings& newCullSettings)
+   {
+      cullSettings = newCullSettings;
+   }
+
 private:
    glm::mat4 worldToView;
    glm::mat4 viewToClip;
    glm::mat4 worldToClip;
+   int lodBias = 0;
+   ViewCullSettings cullSettings;
 };
 
 struct ModelRenderInfo
 {
-   Transform localToWorld;
-   std::vector<bool> visibilityMask;
+   bool isSectionVisible(std::size_t section) const
+   {
+      return section >= visibilityMask.size() || visibilityMask.test(section);
+   }
+
+   InlineBitset visibilityMask; // Empty if all sections are visible
    const Model* model = nullptr;
+   const ModelComponent* component = nullptr; // Provides the cached world matrices and bounds
+   uint32_t lod = 0; // Index of model in the component's LODs
+
+   // Bit i is set if the i-th point / spot light of the scene render info can reach the model (only narrowed down for the
+   // main view, which is the only one that is lit in a forward pass)
+   uint32_t pointLightMask = ~0u;
+   uint32_t spotLightMask = ~0u;
+};
+
+// A single visible mesh section to draw in a pass, ordered by its sort key
+struct SectionRenderInfo
+{
+   uint64_t sortKey = 0;
+   uint32_t modelIndex = 0; // Into the model render info of the same view
+   uint32_t sectionIndex = 0;
+};
+
+// A run of consecutive sections in a pass's draw order that share a mesh section (and material), drawn with a single
+// instanced draw call
+struct InstancedDraw
+{
+   const MeshSection* section = nullptr;
+   const Material* material = nullptr;
+   uint32_t firstInstance = 0;
+   uint32_t numInstances = 0;
+};
+
+// A run of consecutive instanced draws that need no state changes in between: they share a material (in passes that
+// group by material), and a vertex array (the same geometry arena, or none). Draws in an arena are submitted together
+// with a single multi draw indirect call where supported, and all other draws one at a time.
+struct InstancedDrawBatch
+{
+   const Material* material = nullptr;
+   uint32_t firstDraw = 0;
+   uint32_t numDraws = 0;
+   uint32_t firstCommand = 0; // Into the indirect buffer, if multiDraw is set
+   bool multiDraw = false;
 };
 
 struct DirectionalLightUniformData
@@ -110,6 +189,13 @@ struct SpotLightUniformData
    SPtr<Texture> shadowMap = nullptr;
 };
 
+enum class LightType : uint8_t
+{
+   Directional,
+   Point,
+   Spot
+};
+
 struct LightRenderInfo
 {
    SPtr<Framebuffer> shadowMapFramebuffer;
@@ -118,6 +204,8 @@ struct LightRenderInfo
 struct DirectionalLightRenderInfo : public LightRenderInfo
 {
    ViewInfo shadowViewInfo;
+   FrameVector<ModelRenderInfo> shadowModelRenderInfo;
+   FrameVector<SectionRenderInfo> shadowSectionRenderInfo;
    const DirectionalLightComponent* component = nullptr;
 
    DirectionalLightUniformData getUniformData() const;
@@ -127,6 +215,9 @@ struct PointLightRenderInfo : public LightRenderInfo
 {
    float nearPlane = 0.1f;
    float farPlane = 1.0f;
+   std::array<ViewInfo, 6> shadowViewInfo;
+   std::array<FrameVector<ModelRenderInfo>, 6> shadowModelRenderInfo;
+   std::array<FrameVector<SectionRenderInfo>, 6> shadowSectionRenderInfo;
    const PointLightComponent* component = nullptr;
 
    PointLightUniformData getUniformData() const;
@@ -135,18 +226,24 @@ struct PointLightRenderInfo : public LightRenderInfo
 struct SpotLightRenderInfo : public LightRenderInfo
 {
    ViewInfo shadowViewInfo;
+   FrameVector<ModelRenderInfo> shadowModelRenderInfo;
+   FrameVector<SectionRenderInfo> shadowSectionRenderInfo;
    const SpotLightComponent* component = nullptr;
 
    SpotLightUniformData getUniformData() const;
 };
 
+// All containers are allocated from the renderer's frame allocator, so render info is only valid until the next call to
+// calcSceneRenderInfo()
 struct SceneRenderInfo
 {
    ViewInfo viewInfo;
-   std::vector<ModelRenderInfo> modelRenderInfo;
-   std::vector<DirectionalLightRenderInfo> directionalLights;
-   std::vector<PointLightRenderInfo> pointLights;
-   std::vector<SpotLightRenderInfo> spotLights;
+   FrameVector<ModelRenderInfo> modelRenderInfo;
+   FrameVector<SectionRenderInfo> opaqueSectionRenderInfo; // Sorted by program, material, mesh, and then front-to-back
+   FrameVector<SectionRenderInfo> translucentSectionRenderInfo; // Sorted back-to-front
+   FrameVector<DirectionalLightRenderInfo> directionalLights;
+   FrameVector<PointLightRenderInfo> pointLights;
+   FrameVector<SpotLightRenderInfo> spotLights;
 };
 
 class SceneRenderer
@@ -155,13 +252,52 @@ public:
    SceneRenderer(const SPtr<ResourceManager>& inResourceManager, bool hasPositionBuffer);
    virtual ~SceneRenderer() = default;
 
-   virtual void renderScene(const Scene& scene) = 0;
+   virtual void renderScene(Scene& scene) = 0;
 
    virtual void onFramebufferSizeChanged(int newWidth, int newHeight);
 
    void setNearPlaneDistance(float newNearPlaneDistance);
    void setFarPlaneDistance(float newFarPlaneDistance);
 
+   bool isOcclusionCullingEnabled() const
+   {
+      return occlusionBuffer != nullptr;
+   }
+
+   void setOcclusionCullingEnabled(bool enabled);
+
+   int getShadowLodBias() const
+   {
+      return shadowLodBias;
+   }
+
+   // LOD bias of all shadow views (shadows can usually get away with coarser LODs than the main view)
+   void setShadowLodBias(int newShadowLodBias)
+   {
+      shadowLodBias = newShadowLodBias;
+   }
+
+   // Applied to the camera's view (views passed to calcSceneRenderInfo() directly carry their own)
+   const ViewCullSettings& getViewCullSettings() const
+   {
+      return viewCullSettings;
+   }
+
+   void setViewCullSettings(const ViewCullSettings& newViewCullSettings)
+   {
+      viewCullSettings = newViewCullSettings;
+   }
+
+   const ViewCullSettings& getShadowCullSettings() const
+   {
+      return shadowCullSettings;
+   }
+
+   void setShadowCullSettings(const ViewCullSettings& newShadowCullSettings)
+   {
+      shadowCullSettings = newShadowCullSettings;
+   }
+
 protected:
    ResourceManager& getResourceManager() const
    {
@@ -181,11 +317,22 @@ protected:
    }
 
    bool getViewInfo(const Scene& scene, ViewInfo& viewInfo) const;
-   SceneRenderInfo calcSceneRenderInfo(const Scene& scene, const ViewInfo& viewInfo, bool includeLights) const;
+
+   // Culls the main view and the shadow views of all visible shadow casting lights (in parallel). If occlusion culling is
+   // enabled, the main view is also tested against the occluders within it.
+   SceneRenderInfo calcSceneRenderInfo(Scene& scene, const ViewInfo& viewInfo);
 
    void setView(const ViewInfo& viewInfo);
 
-   void renderDepthPass(const SceneRenderInfo& sceneRenderInfo, Framebuffer& framebuffer);
+   // Groups the sections into batches of instanced draws, and uploads the instances (and indirect commands) of all of
+   // them. Batches are only valid until the next call. Passes that use a single program for every material (like the
+   // depth pass) can skip grouping by material.
+   const std::vector<InstancedDrawBatch>& prepareInstancedDraws(const FrameVector<ModelRenderInfo>& models, const FrameVector<SectionRenderInfo>& sections, bool groupByMaterial);
+
+   // The context needs to be set up for the batch's material
+   void submitInstancedDraws(const DrawingContext& context, const InstancedDrawBatch& batch) const;
+
+   void renderDepthPass(const FrameVector<ModelRenderInfo>& models, const FrameVector<SectionRenderInfo>& sections, Framebuffer& framebuffer);
 
    void renderPrePass(const SceneRenderInfo& sceneRenderInfo);
    void setPrePassDepthAttachment(const SPtr<Texture>& depthAttachment);
@@ -193,10 +340,10 @@ protected:
    void renderSSAOPass(const SceneRenderInfo& sceneRenderInfo);
    void setSSAOTextures(const SPtr<Texture>& depthTexture, const SPtr<Texture>& positionTexture, const SPtr<Texture>& normalTexture);
 
-   SPtr<Framebuffer> renderShadowMap(const Scene& scene, const DirectionalLightComponent& directionalLight, ViewInfo& viewInfo);
-   SPtr<Framebuffer> renderShadowMap(const Scene& scene, const PointLightComponent& pointLight, float& nearPlane, float& farPlane);
-   SPtr<Framebuffer> renderShadowMap(const Scene& scene, const SpotLightComponent& spotLight, ViewInfo& viewInfo);
-   void renderShadowMaps(const Scene& scene, SceneRenderInfo& sceneRenderInfo);
+   SPtr<Framebuffer> renderShadowMap(const DirectionalLightRenderInfo& directionalLightRenderInfo);
+   SPtr<Framebuffer> renderShadowMap(const PointLightRenderInfo& pointLightRenderInfo);
+   SPtr<Framebuffer> renderShadowMap(const SpotLightRenderInfo& spotLightRenderInfo);
+   void renderShadowMaps(SceneRenderInfo& sceneRenderInfo);
 
    void renderTranslucencyPass(const SceneRenderInfo& sceneRenderInfo);
    void setTranslucencyPassAttachments(const SPtr<Texture>& depthAttachment, const SPtr<Texture>& colorAttachment);
@@ -233,6 +380,19 @@ protected:
       return viewUniformBuffer;
    }
 
+   const SPtr<UniformBufferObject>& getLightUniformBuffer() const
+   {
+      return lightUniformBuffer;
+   }
+
+   // Programs that read the light uniform block need to be compiled with the number of lights of each type that it holds
+   static void addLightDefinitions(ShaderSpecification& shaderSpecification);
+
+   // The light uniform buffer holds a limited number of lights of each type, starting with the first ones of the frame.
+   // Returns the index of the given light within the buffer, uploading the range of lights that starts with it first if it
+   // isn't there (which only happens in passes that go through every light, like the deferred lighting pass).
+   int selectLightUniformIndex(const SceneRenderInfo& sceneRenderInfo, LightType type, int lightIndex);
+
    void loadForwardProgramPermutations();
    int selectForwardPermutation(const Material& material);
    void populateForwardUniforms(const SceneRenderInfo& sceneRenderInfo, std::array<DrawingContext, 8>& contexts);
@@ -256,15 +416,43 @@ protected:
    SPtr<Framebuffer> obtainCubeShadowMap(int size);
 
 private:
+   // Packs every light that fits into the light uniform buffer, starting at the given light of each type
+   void updateLightUniformBuffer(const SceneRenderInfo& sceneRenderInfo, const std::array<int, 3>& firstLights);
+
+   struct CachedShadowMap
+   {
+      SPtr<Framebuffer> framebuffer;
+      uint64_t signature = 0;
+   };
+
    float nearPlaneDistance;
    float farPlaneDistance;
+   int shadowLodBias = 0;
+   ViewCullSettings viewCullSettings;
+   ViewCullSettings shadowCullSettings;
 
    SPtr<ResourceManager> resourceManager;
    ResourcePool<Framebuffer> shadowMapPool;
+   std::unordered_map<const LightComponent*, CachedShadowMap> cachedShadowMaps;
+
+   UPtr<OcclusionBuffer> occlusionBuffer;
+   FrameAllocator frameAllocator;
+   std::vector<uint64_t> lightVisibility;
 
    Mesh screenMesh;
 
    SPtr<UniformBufferObject> viewUniformBuffer;
+   SPtr<UniformBufferObject> lightUniformBuffer;
+   std::array<int, 3> lightUniformBufferFirstLights = {}; // Indexed by light type
+
+   InstanceBuffer instanceBuffer;
+   std::vector<InstanceData> instances;
+   std::vector<InstancedDraw> instancedDraws;
+   std::vector<InstancedDrawBatch> instancedDrawBatches;
+#if SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
+   BufferObject indirectBuffer;
+   std::vector<DrawElementsIndirectCommand> indirectCommands;
+#endif // SWAP_GL_MULTI_DRAW_INDIRECT_SUPPORTED
 
    SPtr<Texture> dummyShadowMap;
    SPtr<Texture> dummyShadowCubeMap;
@@ -1,37 +1,100 @@
 #include "Scene/Scene.h"
 
 #include "Core/Assert.h"
+#include "Core/ThreadPool.h"
+#include "Math/MathUtils.h"
 #include "Scene/Components/CameraComponent.h"
+#include "Scene/Components/Lights/DirectionalLightComponent.h"
+#include "Scene/Components/Lights/PointLightComponent.h"
+#include "Scene/Components/Lights/SpotLightComponent.h"
 #include "Scene/Components/ModelComponent.h"
+#include "Scene/Components/SceneComponent.h"
 
 #include <algorithm>
 
 namespace
 {
-   template<typename T>
-   void registerComponent(std::vector<T*>& components, T* component)
+   const std::size_t kNotInScene = static_cast<std::size_t>(-1);
+   const std::size_t kNotInSceneList = static_cast<std::size_t>(-1);
+   const std::size_t kNotInTickList = static_cast<std::size_t>(-1);
+   const std::size_t kNotInDirtyTransformList = static_cast<std::size_t>(-1);
+   const std::size_t kNotInDirtyList = static_cast<std::size_t>(-1);
+
+   // Number of components each parallel tick job handles, to keep scheduling overhead low for cheap tick functions
+   const std::size_t kTickBatchSize = 64;
+
+   std::size_t getHierarchyDepth(const SceneComponent& sceneComponent)
    {
-      ASSERT(component);
-      ASSERT(std::find(components.begin(), components.end(), component) == components.end());
+      std::size_t depth = 0;
+      for (const SceneComponent* parent = sceneComponent.getParent(); parent; parent = parent->getParent())
+      {
+         ++depth;
+      }
 
-      components.push_back(component);
+      return depth;
    }
 
    template<typename T>
-   void unregisterComponent(std::vector<T*>& components, T* component)
+   std::size_t countComponentsOfType(gsl::span<const ComponentTypeMask> componentTypeMasks)
+   {
+      ComponentTypeMask typeBit = ComponentTypeMask(1) << ComponentTypeInfo<T>::getId();
+      return std::count_if(componentTypeMasks.begin(), componentTypeMasks.end(), [typeBit](ComponentTypeMask mask)
+      {
+         return (mask & typeBit) != 0;
+      });
+   }
+
+   Bounds calcPointLightBounds(const PointLightComponent& pointLight)
+   {
+      Bounds bounds;
+      bounds.center = pointLight.getAbsoluteTransform().position;
+      bounds.radius = pointLight.getScaledRadius();
+      bounds.extent = glm::vec3(bounds.radius);
+
+      return bounds;
+   }
+
+   // Smallest sphere around the light's cone (a spherical sector, since the light's range is measured from its origin)
+   Bounds calcSpotLightBounds(const SpotLightComponent& spotLight)
    {
-      ASSERT(component);
+      const Transform& localToWorld = spotLight.getAbsoluteTransform();
+      glm::vec3 forward = localToWorld.rotateVector(MathUtils::kForwardVector);
+
+      float range = spotLight.getScaledRadius();
+      float halfAngle = glm::radians(spotLight.getCutoffAngle());
+
+      float centerDistance = 0.0f;
+      float radius = range;
+      if (halfAngle <= glm::radians(45.0f))
+      {
+         // Narrow cones: the sphere passes through the origin and the rim of the cap
+         centerDistance = range / (2.0f * glm::cos(halfAngle));
+         radius = centerDistance;
+      }
+      else if (halfAngle < glm::radians(90.0f))
+      {
+         // Wide cones: the sphere is centered on the rim of the cap
+         centerDistance = range * glm::cos(halfAngle);
+         radius = range * glm::sin(halfAngle);
+      }
 
-      auto location = std::find(components.begin(), components.end(), component);
-      ASSERT(location != components.end());
+      Bounds bounds;
+      bounds.center = localToWorld.position + forward * centerDistance;
+      bounds.radius = radius;
+      bounds.extent = glm::vec3(radius);
 
-      components.erase(location);
+      return bounds;
    }
 }
 
 Scene::Scene()
    : time(0.0f)
    , deltaTime(0.0f)
+   , ticking(false)
+   , parallelTickEnabled(false)
+   , tickingInParallel(false)
+   , tickingComponentsRemoved(false)
+   , transformsReadOnly(false)
    , activeCameraComponent(nullptr)
 {
 }
@@ -39,15 +102,22 @@ Scene::Scene()
 Scene::~Scene()
 {
    entities.clear();
+   ASSERT(dirtyTransformComponents.empty());
 
    cameraComponents.clear();
    activeCameraComponent = nullptr;
 
    modelComponents.clear();
+   dirtyModelComponents.clear();
 
    directionalLightComponents.clear();
    pointLightComponents.clear();
    spotLightComponents.clear();
+   dirtyLightComponents.clear();
+
+   tickingComponents.clear();
+   lastTickTimes.clear();
+   nextTickTimes.clear();
 }
 
 void Scene::tick(float dt)
@@ -55,35 +125,538 @@ void Scene::tick(float dt)
    time += dt;
    deltaTime = dt;
 
-   for (const UPtr<Entity>& entity : entities)
+   // Destruction is deferred so that the entity list stays intact
+   ticking = true;
+   if (parallelTickEnabled)
+   {
+      tickParallel();
+   }
+   else
+   {
+      tickSerial();
+   }
+   ticking = false;
+
+   compactTickingComponents();
+
+   flushEntityDestructionQueue();
+
+   updateDerivedData();
+}
+
+void Scene::updateDerivedData()
+{
+   ASSERT(!ticking);
+
+   resolveTransforms();
+   updateModelBoundingVolumes();
+   updateLightData();
+}
+
+void Scene::tickSerial()
+{
+   // Components that start ticking during the tick are ticked as well
+   for (std::size_t i = 0; i < tickingComponents.size(); ++i)
+   {
+      if (tickingComponents[i] && time >= nextTickTimes[i])
+      {
+         tickingComponents[i]->tick(time - lastTickTimes[i]);
+
+         // The tick function may have been cleared by the tick
+         if (tickingComponents[i])
+         {
+            finishComponentTick(i);
+         }
+      }
+   }
+}
+
+void Scene::tickParallel()
+{
+   for (TickGroupComponents& group : tickGroupComponents)
+   {
+      for (std::vector<std::size_t>& phase : group.parallelPhases)
+      {
+         phase.clear();
+      }
+      group.serialComponents.clear();
+   }
+   dueTickIndices.clear();
+
+   // Components are bucketed in tick list order, so that the serial ones tick in the same order as they otherwise would
+   for (std::size_t i = 0; i < tickingComponents.size(); ++i)
+   {
+      Component* component = tickingComponents[i];
+      if (!component || time < nextTickTimes[i])
+      {
+         continue;
+      }
+      dueTickIndices.push_back(i);
+
+      const TickSettings& tickSettings = component->tickSettings;
+      TickGroupComponents& group = tickGroupComponents[static_cast<std::size_t>(tickSettings.group)];
+
+      if (!tickSettings.threadSafe)
+      {
+         group.serialComponents.push_back(i);
+         continue;
+      }
+
+      // Ticking by depth means that every ancestor has finished moving before any of its descendants tick
+      std::size_t phase = 0;
+      if ((tickSettings.readsParentTransform || tickSettings.writesTransform) && component->isA<SceneComponent>())
+      {
+         phase = getHierarchyDepth(static_cast<const SceneComponent&>(*component));
+      }
+
+      if (phase >= group.parallelPhases.size())
+      {
+         group.parallelPhases.resize(phase + 1);
+      }
+      group.parallelPhases[phase].push_back(i);
+   }
+
+   // Last tick times are only updated once everything has ticked, so they can be read from any thread in the meantime
+   auto tickComponent = [this](std::size_t index)
+   {
+      if (Component* component = tickingComponents[index])
+      {
+         component->tick(time - lastTickTimes[index]);
+      }
+   };
+
+   for (TickGroupComponents& group : tickGroupComponents)
+   {
+      for (const std::vector<std::size_t>& phase : group.parallelPhases)
+      {
+         if (phase.empty())
+         {
+            continue;
+         }
+
+         // Absolute transforms are resolved lazily, which would race if components tried to resolve a shared ancestor (at
+         // any depth) at the same time - so resolve everything that earlier phases and serial ticks moved up front
+         resolveTransforms();
+
+         std::size_t numBatches = (phase.size() + kTickBatchSize - 1) / kTickBatchSize;
+
+         tickingInParallel = true;
+         ThreadPool::instance().parallelFor(numBatches, [&phase, &tickComponent](std::size_t batch)
+         {
+            std::size_t end = std::min(phase.size(), (batch + 1) * kTickBatchSize);
+            for (std::size_t i = batch * kTickBatchSize; i < end; ++i)
+            {
+               tickComponent(phase[i]);
+            }
+         });
+         tickingInParallel = false;
+      }
+
+      for (std::size_t index : group.serialComponents)
+      {
+         tickComponent(index);
+      }
+   }
+
+   for (std::size_t index : dueTickIndices)
+   {
+      if (tickingComponents[index])
+      {
+         finishComponentTick(index);
+      }
+   }
+}
+
+void Scene::finishComponentTick(std::size_t tickListIndex)
+{
+   Component* component = tickingComponents[tickListIndex];
+   const TickSettings& tickSettings = component->tickSettings;
+
+   float interval = tickSettings.interval;
+   if (tickSignificanceFunction && tickSettings.maxInterval > tickSettings.interval)
+   {
+      float significance = glm::clamp(tickSignificanceFunction(*component), 0.0f, 1.0f);
+      interval = glm::mix(tickSettings.maxInterval, tickSettings.interval, significance);
+   }
+
+   lastTickTimes[tickListIndex] = time;
+   nextTickTimes[tickListIndex] = time + interval;
+}
+
+void Scene::registerTickingComponent(Component* component)
+{
+   ASSERT(component && component->tickListIndex == kNotInTickList);
+   ASSERT(!tickingInParallel, "Tick functions can't be set from thread safe tick functions");
+
+   component->tickListIndex = tickingComponents.size();
+   tickingComponents.push_back(component);
+
+   // Due right away (including during the current tick), with the time since the start of the tick
+   lastTickTimes.push_back(ticking ? time - deltaTime : time);
+   nextTickTimes.push_back(time);
+}
+
+void Scene::unregisterTickingComponent(Component* component)
+{
+   ASSERT(component);
+   ASSERT(!tickingInParallel, "Tick functions can't be cleared from thread safe tick functions");
+
+   std::size_t index = component->tickListIndex;
+   ASSERT(index < tickingComponents.size() && tickingComponents[index] == component);
+
+   component->tickListIndex = kNotInTickList;
+
+   // The list is being iterated while ticking, so just leave a hole that gets compacted afterwards
+   if (ticking)
+   {
+      tickingComponents[index] = nullptr;
+      tickingComponentsRemoved = true;
+      return;
+   }
+
+   // Swap and pop
+   if (index != tickingComponents.size() - 1)
+   {
+      tickingComponents[index] = tickingComponents.back();
+      tickingComponents[index]->tickListIndex = index;
+      lastTickTimes[index] = lastTickTimes.back();
+      nextTickTimes[index] = nextTickTimes.back();
+   }
+   tickingComponents.pop_back();
+   lastTickTimes.pop_back();
+   nextTickTimes.pop_back();
+}
+
+void Scene::compactTickingComponents()
+{
+   if (!tickingComponentsRemoved)
+   {
+      return;
+   }
+
+   std::size_t numRemaining = 0;
+   for (std::size_t i = 0; i < tickingComponents.size(); ++i)
    {
-      entity->tick(dt);
+      if (Component* component = tickingComponents[i])
+      {
+         tickingComponents[numRemaining] = component;
+         lastTickTimes[numRemaining] = lastTickTimes[i];
+         nextTickTimes[numRemaining] = nextTickTimes[i];
+         component->tickListIndex = numRemaining;
+         ++numRemaining;
+      }
    }
+
+   tickingComponents.resize(numRemaining);
+   lastTickTimes.resize(numRemaining);
+   nextTickTimes.resize(numRemaining);
+   tickingComponentsRemoved = false;
+}
+
+void Scene::markTransformDirty(SceneComponent* sceneComponent)
+{
+   ASSERT(sceneComponent && sceneComponent->dirtyTransformListIndex == kNotInDirtyTransformList);
+
+   std::unique_lock<std::mutex> lock = lockIfTickingInParallel();
+
+   sceneComponent->dirtyTransformListIndex = dirtyTransformComponents.size();
+   dirtyTransformComponents.push_back(sceneComponent);
+}
+
+void Scene::unmarkTransformDirty(SceneComponent* sceneComponent)
+{
+   ASSERT(sceneComponent);
+
+   std::unique_lock<std::mutex> lock = lockIfTickingInParallel();
+
+   std::size_t index = sceneComponent->dirtyTransformListIndex;
+   ASSERT(index < dirtyTransformComponents.size() && dirtyTransformComponents[index] == sceneComponent);
+
+   // Swap and pop
+   if (index != dirtyTransformComponents.size() - 1)
+   {
+      dirtyTransformComponents[index] = dirtyTransformComponents.back();
+      dirtyTransformComponents[index]->dirtyTransformListIndex = index;
+   }
+   dirtyTransformComponents.pop_back();
+
+   sceneComponent->dirtyTransformListIndex = kNotInDirtyTransformList;
+}
+
+void Scene::resolveTransforms()
+{
+   ASSERT(!tickingInParallel && !transformsReadOnly);
+
+   for (SceneComponent* sceneComponent : dirtyTransformComponents)
+   {
+      sceneComponent->dirtyTransformListIndex = kNotInDirtyTransformList;
+      sceneComponent->resolveTransforms();
+   }
+   dirtyTransformComponents.clear();
+}
+
+std::unique_lock<std::mutex> Scene::lockIfTickingInParallel()
+{
+   std::unique_lock<std::mutex> lock(tickMutex, std::defer_lock);
+   if (tickingInParallel)
+   {
+      lock.lock();
+   }
+
+   return lock;
+}
+
+std::vector<Entity*> Scene::createEntities(gsl::span<const uint32_t> componentCounts, gsl::span<const ComponentClass* const> componentClasses)
+{
+   std::vector<ComponentTypeMask> componentTypeMasks(componentClasses.size());
+   for (std::size_t i = 0; i < componentClasses.size(); ++i)
+   {
+      ASSERT(componentClasses[i]);
+      componentTypeMasks[i] = componentClasses[i]->typeMask;
+   }
+   reserveEntities(componentCounts.size(), componentTypeMasks, 1);
+
+   std::vector<Entity*> newEntities;
+   newEntities.reserve(componentCounts.size());
+
+   std::size_t firstComponent = 0;
+   for (uint32_t componentCount : componentCounts)
+   {
+      ASSERT(firstComponent + componentCount <= static_cast<std::size_t>(componentClasses.size()));
+      newEntities.push_back(addEntity(Entity::create(componentClasses.subspan(firstComponent, componentCount), *this)));
+      firstComponent += componentCount;
+   }
+
+   return newEntities;
 }
 
 bool Scene::destroyEntity(Entity* entityToDestroy)
 {
-   auto location = std::find_if(entities.begin(), entities.end(), [entityToDestroy](const UPtr<Entity>& entity)
+   if (!ownsEntity(entityToDestroy))
    {
-      return entity.get() == entityToDestroy;
-   });
+      return false;
+   }
 
-   if (location != entities.end())
+   if (ticking)
+   {
+      queueEntityDestruction(entityToDestroy);
+   }
+   else
    {
-      entities.erase(location);
-      return true;
+      EntityHandle handle = entityToDestroy->handle;
+      destroyEntities(gsl::span<const EntityHandle>(&handle, 1));
    }
 
-   return false;
+   return true;
+}
+
+void Scene::destroyEntities(gsl::span<const EntityHandle> entitiesToDestroy)
+{
+   if (ticking)
+   {
+      for (const EntityHandle& handle : entitiesToDestroy)
+      {
+         if (Entity* entity = resolveEntityHandle(handle))
+         {
+            queueEntityDestruction(entity);
+         }
+      }
+
+      return;
+   }
+
+   // Move the entities out of the list (swapping each with the end), and only destroy them once the list is consistent
+   // again, since destruction can trigger more scene changes
+   std::vector<UPtr<Entity>> destroyedEntities;
+   destroyedEntities.reserve(entitiesToDestroy.size());
+
+   for (const EntityHandle& handle : entitiesToDestroy)
+   {
+      // Skips entities that were destroyed by an earlier call (their handles no longer resolve), and duplicates (which
+      // still resolve until the end of this call, but have already been taken out of the list)
+      Entity* entity = resolveEntityHandle(handle);
+      if (!entity || entity->sceneIndex == kNotInScene)
+      {
+         continue;
+      }
+
+      std::size_t index = entity->sceneIndex;
+      entity->pendingDestruction = true;
+      entity->sceneIndex = kNotInScene;
+      destroyedEntities.push_back(std::move(entities[index]));
+
+      if (index != entities.size() - 1)
+      {
+         entities[index] = std::move(entities.back());
+         entities[index]->sceneIndex = index;
+      }
+      entities.pop_back();
+   }
+
+   for (const UPtr<Entity>& entity : destroyedEntities)
+   {
+      EntitySlot& slot = entitySlots[entity->handle.index];
+      slot.entity = nullptr;
+      ++slot.generation;
+      freeEntitySlots.push_back(entity->handle.index);
+   }
+
+   destroyedEntities.clear();
+}
+
+void Scene::queueEntityDestruction(Entity* entityToDestroy)
+{
+   ASSERT(ownsEntity(entityToDestroy));
+
+   std::unique_lock<std::mutex> lock = lockIfTickingInParallel();
+
+   // Handles are queued, so that entities destroyed directly in the meantime are skipped
+   entityToDestroy->pendingDestruction = true;
+   entityDestructionQueue.push_back(entityToDestroy->handle);
+}
+
+Entity* Scene::resolveEntityHandle(const EntityHandle& handle) const
+{
+   if (handle.index < entitySlots.size())
+   {
+      const EntitySlot& slot = entitySlots[handle.index];
+      if (slot.generation == handle.generation)
+      {
+         return slot.entity;
+      }
+   }
+
+   return nullptr;
 }
 
 void Scene::setActiveCameraComponent(CameraComponent* newActiveCameraComponent)
 {
-   ASSERT(!newActiveCameraComponent || std::find(cameraComponents.begin(), cameraComponents.end(), newActiveCameraComponent) != cameraComponents.end());
+   ASSERT(!newActiveCameraComponent || (newActiveCameraComponent->sceneListIndex < cameraComponents.size() && cameraComponents[newActiveCameraComponent->sceneListIndex] == newActiveCameraComponent));
 
    activeCameraComponent = newActiveCameraComponent;
 }
 
+Entity* Scene::addEntity(UPtr<Entity> entity)
+{
+   ASSERT(entity);
+   ASSERT(!tickingInParallel, "Entities can't be created from thread safe tick functions");
+
+   uint32_t slotIndex = 0;
+   if (freeEntitySlots.empty())
+   {
+      slotIndex = static_cast<uint32_t>(entitySlots.size());
+      entitySlots.emplace_back();
+   }
+   else
+   {
+      slotIndex = freeEntitySlots.back();
+      freeEntitySlots.pop_back();
+   }
+
+   EntitySlot& slot = entitySlots[slotIndex];
+   slot.entity = entity.get();
+
+   entity->handle.index = slotIndex;
+   entity->handle.generation = slot.generation;
+   entity->sceneIndex = entities.size();
+
+   entities.push_back(std::move(entity));
+   return entities.back().get();
+}
+
+void Scene::reserveEntities(std::size_t entityCount, gsl::span<const ComponentTypeMask> componentTypeMasks, std::size_t maskRepeatCount)
+{
+   entities.reserve(entities.size() + entityCount);
+   entitySlots.reserve(entitySlots.size() + (entityCount > freeEntitySlots.size() ? entityCount - freeEntitySlots.size() : 0));
+
+   cameraComponents.reserve(cameraComponents.size() + maskRepeatCount * countComponentsOfType<CameraComponent>(componentTypeMasks));
+   modelComponents.reserve(modelComponents.size() + maskRepeatCount * countComponentsOfType<ModelComponent>(componentTypeMasks));
+   directionalLightComponents.reserve(directionalLightComponents.size() + maskRepeatCount * countComponentsOfType<DirectionalLightComponent>(componentTypeMasks));
+   pointLightComponents.reserve(pointLightComponents.size() + maskRepeatCount * countComponentsOfType<PointLightComponent>(componentTypeMasks));
+   pointLightData.bounds.reserve(pointLightComponents.capacity());
+   pointLightData.castShadows.reserve(pointLightComponents.capacity());
+   spotLightComponents.reserve(spotLightComponents.size() + maskRepeatCount * countComponentsOfType<SpotLightComponent>(componentTypeMasks));
+   spotLightData.bounds.reserve(spotLightComponents.capacity());
+   spotLightData.castShadows.reserve(spotLightComponents.capacity());
+}
+
+bool Scene::ownsEntity(const Entity* entity) const
+{
+   return entity && entity->sceneIndex < entities.size() && entities[entity->sceneIndex].get() == entity;
+}
+
+void Scene::flushEntityDestructionQueue()
+{
+   // Destroying entities can queue more, so keep going until the queue is empty
+   std::vector<EntityHandle> entitiesToDestroy;
+   while (!entityDestructionQueue.empty())
+   {
+      // Entities may have been queued from several threads, so destroy them in an order that doesn't depend on timing
+      if (parallelTickEnabled)
+      {
+         std::sort(entityDestructionQueue.begin(), entityDestructionQueue.end(), [](const EntityHandle& first, const EntityHandle& second)
+         {
+            return first.index < second.index;
+         });
+      }
+
+      entitiesToDestroy.clear();
+      entitiesToDestroy.swap(entityDestructionQueue);
+
+      destroyEntities(entitiesToDestroy);
+   }
+}
+
+template<typename T>
+void Scene::registerComponent(std::vector<T*>& components, T* component)
+{
+   ASSERT(component);
+   ASSERT(component->sceneListIndex == kNotInSceneList);
+
+   component->sceneListIndex = components.size();
+   components.push_back(component);
+}
+
+template<typename T>
+std::size_t Scene::unregisterComponent(std::vector<T*>& components, T* component)
+{
+   ASSERT(component);
+
+   std::size_t index = component->sceneListIndex;
+   ASSERT(index < components.size() && components[index] == component);
+
+   // Swap and pop
+   if (index != components.size() - 1)
+   {
+      components[index] = components.back();
+      components[index]->sceneListIndex = index;
+   }
+   components.pop_back();
+
+   component->sceneListIndex = kNotInSceneList;
+
+   return index;
+}
+
+template<typename T>
+void Scene::removeDirtyComponent(std::vector<T*>& dirtyComponents, T* component)
+{
+   ASSERT(component);
+
+   std::size_t index = component->dirtyListIndex;
+   ASSERT(index < dirtyComponents.size() && dirtyComponents[index] == component);
+
+   // Swap and pop
+   if (index != dirtyComponents.size() - 1)
+   {
+      dirtyComponents[index] = dirtyComponents.back();
+      dirtyComponents[index]->dirtyListIndex = index;
+   }
+   dirtyComponents.pop_back();
+
+   component->dirtyListIndex = kNotInDirtyList;
+}
+
 void Scene::registerCameraComponent(CameraComponent* cameraComponent)
 {
    registerComponent(cameraComponents, cameraComponent);
@@ -102,11 +675,58 @@ void Scene::unregisterCameraComponent(CameraComponent* cameraComponent)
 void Scene::registerModelComponent(ModelComponent* modelComponent)
 {
    registerComponent(modelComponents, modelComponent);
+
+   ASSERT(modelComponent->boundingVolumeId == BoundingVolumeHierarchy<ModelComponent>::kInvalidNode);
+   modelComponent->updateRenderData();
+   modelComponent->boundingVolumeId = modelBoundingVolumeHierarchy.insert(modelComponent->getWorldBounds(), modelComponent);
 }
 
 void Scene::unregisterModelComponent(ModelComponent* modelComponent)
 {
    unregisterComponent(modelComponents, modelComponent);
+
+   if (modelComponent->boundingVolumeDirty)
+   {
+      removeDirtyComponent(dirtyModelComponents, modelComponent);
+      modelComponent->boundingVolumeDirty = false;
+   }
+
+   modelBoundingVolumeHierarchy.remove(modelComponent->boundingVolumeId);
+   modelComponent->boundingVolumeId = BoundingVolumeHierarchy<ModelComponent>::kInvalidNode;
+}
+
+void Scene::markModelComponentDirty(ModelComponent* modelComponent)
+{
+   ASSERT(modelComponent && !modelComponent->boundingVolumeDirty);
+
+   std::unique_lock<std::mutex> lock = lockIfTickingInParallel();
+
+   modelComponent->boundingVolumeDirty = true;
+   modelComponent->dirtyListIndex = dirtyModelComponents.size();
+   dirtyModelComponents.push_back(modelComponent);
+}
+
+void Scene::updateModelBoundingVolumes()
+{
+   // Leaves are stored with some slack, so this only restructures the tree for models that moved a significant amount.
+   // This also recomputes the cached render data of all changed models, so that rendering only reads it.
+   if (parallelTickEnabled)
+   {
+      // The tree's structure depends on the update order, which needs to be the same no matter how ticks were scheduled
+      std::sort(dirtyModelComponents.begin(), dirtyModelComponents.end(), [](const ModelComponent* first, const ModelComponent* second)
+      {
+         return first->sceneListIndex < second->sceneListIndex;
+      });
+   }
+
+   for (ModelComponent* modelComponent : dirtyModelComponents)
+   {
+      modelComponent->updateRenderData();
+      modelBoundingVolumeHierarchy.update(modelComponent->boundingVolumeId, modelComponent->getWorldBounds());
+      modelComponent->boundingVolumeDirty = false;
+      modelComponent->dirtyListIndex = kNotInDirtyList;
+   }
+   dirtyModelComponents.clear();
 }
 
 void Scene::registerDirectionalLightComponent(DirectionalLightComponent* directionalLightComponent)
@@ -117,24 +737,127 @@ void Scene::registerDirectionalLightComponent(DirectionalLightComponent* directi
 void Scene::unregisterDirectionalLightComponent(DirectionalLightComponent* directionalLightComponent)
 {
    unregisterComponent(directionalLightComponents, directionalLightComponent);
+
+   if (directionalLightComponent->lightDataDirty)
+   {
+      removeDirtyComponent<LightComponent>(dirtyLightComponents, directionalLightComponent);
+      directionalLightComponent->lightDataDirty = false;
+   }
 }
 
 void Scene::registerPointLightComponent(PointLightComponent* pointLightComponent)
 {
    registerComponent(pointLightComponents, pointLightComponent);
+
+   Bounds bounds = calcPointLightBounds(*pointLightComponent);
+   pointLightData.add(bounds, pointLightComponent->getCastShadows());
+   pointLightComponent->boundingVolumeId = lightBoundingVolumeHierarchy.insert(bounds, pointLightComponent);
 }
 
 void Scene::unregisterPointLightComponent(PointLightComponent* pointLightComponent)
 {
-   unregisterComponent(pointLightComponents, pointLightComponent);
+   std::size_t index = unregisterComponent(pointLightComponents, pointLightComponent);
+   pointLightData.removeSwap(index);
+
+   lightBoundingVolumeHierarchy.remove(pointLightComponent->boundingVolumeId);
+   pointLightComponent->boundingVolumeId = BoundingVolumeHierarchy<LightComponent>::kInvalidNode;
+
+   if (pointLightComponent->lightDataDirty)
+   {
+      removeDirtyComponent<LightComponent>(dirtyLightComponents, pointLightComponent);
+      pointLightComponent->lightDataDirty = false;
+   }
 }
 
 void Scene::registerSpotLightComponent(SpotLightComponent* spotLightComponent)
 {
    registerComponent(spotLightComponents, spotLightComponent);
+
+   Bounds bounds = calcSpotLightBounds(*spotLightComponent);
+   spotLightData.add(bounds, spotLightComponent->getCastShadows());
+   spotLightComponent->boundingVolumeId = lightBoundingVolumeHierarchy.insert(bounds, spotLightComponent);
 }
 
 void Scene::unregisterSpotLightComponent(SpotLightComponent* spotLightComponent)
 {
-   unregisterComponent(spotLightComponents, spotLightComponent);
+   std::size_t index = unregisterComponent(spotLightComponents, spotLightComponent);
+   spotLightData.removeSwap(index);
+
+   lightBoundingVolumeHierarchy.remove(spotLightComponent->boundingVolumeId);
+   spotLightComponent->boundingVolumeId = BoundingVolumeHierarchy<LightComponent>::kInvalidNode;
+
+   if (spotLightComponent->lightDataDirty)
+   {
+      removeDirtyComponent<LightComponent>(dirtyLightComponents, spotLightComponent);
+      spotLightComponent->lightDataDirty = false;
+   }
+}
+
+void Scene::markLightComponentDirty(LightComponent* lightComponent)
+{
+   ASSERT(lightComponent && !lightComponent->lightDataDirty);
+
+   std::unique_lock<std::mutex> lock = lockIfTickingInParallel();
+
+   lightComponent->lightDataDirty = true;
+   lightComponent->dirtyListIndex = dirtyLightComponents.size();
+   dirtyLightComponents.push_back(lightComponent);
+}
+
+void Scene::updateLightData()
+{
+   if (parallelTickEnabled)
+   {
+      // As with models, keep the tree's structure independent of how ticks were scheduled
+      std::sort(dirtyLightComponents.begin(), dirtyLightComponents.end(), [](const LightComponent* first, const LightComponent* second)
+      {
+         return first->boundingVolumeId < second->boundingVolumeId;
+      });
+   }
+
+   for (LightComponent* lightComponent : dirtyLightComponents)
+   {
+      lightComponent->lightDataDirty = false;
+      lightComponent->dirtyListIndex = kNotInDirtyList;
+
+      if (lightComponent->isA<PointLightComponent>())
+      {
+         const PointLightComponent* pointLightComponent = static_cast<const PointLightComponent*>(lightComponent);
+
+         Bounds bounds = calcPointLightBounds(*pointLightComponent);
+         pointLightData.set(pointLightComponent->sceneListIndex, bounds, pointLightComponent->getCastShadows());
+         lightBoundingVolumeHierarchy.update(pointLightComponent->boundingVolumeId, bounds);
+      }
+      else if (lightComponent->isA<SpotLightComponent>())
+      {
+         const SpotLightComponent* spotLightComponent = static_cast<const SpotLightComponent*>(lightComponent);
+
+         Bounds bounds = calcSpotLightBounds(*spotLightComponent);
+         spotLightData.set(spotLightComponent->sceneListIndex, bounds, spotLightComponent->getCastShadows());
+         lightBoundingVolumeHierarchy.update(spotLightComponent->boundingVolumeId, bounds);
+      }
+   }
+   dirtyLightComponents.clear();
+}
+
+namespace TickSignificance
+{
+   Scene::TickSignificanceFunction cameraDistance(float fullDistance, float zeroDistance)
+   {
+      ASSERT(zeroDistance > fullDistance);
+
+      return [fullDistance, zeroDistance](const Component& component)
+      {
+         const CameraComponent* camera = component.getScene().getActiveCameraComponent();
+         if (!camera || !component.isA<SceneComponent>())
+         {
+            return 1.0f;
+         }
+
+         const SceneComponent& sceneComponent = static_cast<const SceneComponent&>(component);
+         float distance = glm::distance(sceneComponent.getAbsolutePosition(), camera->getAbsolutePosition());
+
+         return 1.0f - glm::clamp((distance - fullDistance) / (zeroDistance - fullDistance), 0.0f, 1.0f);
+      };
+   }
 }
@@ -2,28 +2,76 @@
 
 #include "Core/Delegate.h"
 #include "Core/Pointers.h"
+#include "Math/BoundingVolumeHierarchy.h"
+#include "Math/FrustumCulling.h"
 #include "Scene/Entity.h"
 
 #include <gsl/span>
 
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 class CameraComponent;
 class DirectionalLightComponent;
+class LightComponent;
 class ModelComponent;
 class PointLightComponent;
+class SceneComponent;
 class SpotLightComponent;
 
+// Hot data of one type of light, stored as structures of arrays in the same order as the scene's list of those lights,
+// so that light gathering can stream through it (and cull it in batches) without touching the components themselves
+struct LightSceneData
+{
+   PackedBounds bounds;
+   std::vector<uint8_t> castShadows;
+
+   std::size_t size() const
+   {
+      return castShadows.size();
+   }
+
+   void add(const Bounds& lightBounds, bool lightCastsShadows)
+   {
+      bounds.add(lightBounds);
+      castShadows.push_back(lightCastsShadows);
+   }
+
+   void set(std::size_t index, const Bounds& lightBounds, bool lightCastsShadows)
+   {
+      bounds.set(index, lightBounds);
+      castShadows[index] = lightCastsShadows;
+   }
+
+   void removeSwap(std::size_t index)
+   {
+      bounds.removeSwap(index);
+      castShadows[index] = castShadows.back();
+      castShadows.pop_back();
+   }
+};
+
 class Scene
 {
 public:
+   // Returns how significant the component currently is, from 0 (not at all) to 1 (fully)
+   using TickSignificanceFunction = std::function<float(const Component&)>;
+
    Scene();
    ~Scene();
 
    void tick(float dt);
 
+   // Brings everything derived from the components up to date: absolute transforms, cached model render data, and the
+   // model and light bounding volumes and light data. Done at the end of each tick, and by the renderer in case anything
+   // changed since then (e.g. from input handlers, or when rendering without ticking).
+   void updateDerivedData();
+
    float getTime() const
    {
       return time;
@@ -34,21 +82,78 @@ public:
       return deltaTime;
    }
 
+   bool isParallelTickEnabled() const
+   {
+      return parallelTickEnabled;
+   }
+
+   // When enabled, thread safe tick functions run on the thread pool, in phases that follow the transform hierarchy (see
+   // TickSettings). Results don't depend on scheduling, as long as every component declares its tick settings correctly.
+   void setParallelTickEnabled(bool enabled)
+   {
+      parallelTickEnabled = enabled;
+   }
+
+   // Used to throttle components that have a max tick interval (see TickSettings)
+   void setTickSignificanceFunction(TickSignificanceFunction newTickSignificanceFunction)
+   {
+      tickSignificanceFunction = std::move(newTickSignificanceFunction);
+   }
+
+   void registerTickingComponent(Component* component);
+   void unregisterTickingComponent(Component* component);
+
+   // Queues the component's absolute transform (and those of its descendants) to be resolved by resolveTransforms()
+   void markTransformDirty(SceneComponent* sceneComponent);
+   void unmarkTransformDirty(SceneComponent* sceneComponent);
+
+   // Resolves all absolute transforms that are out of date (see updateDerivedData()), and before each parallel tick phase
+   void resolveTransforms();
+
+   // Set while transforms are being read from several threads, during which none of them may be resolved lazily
+   bool areTransformsReadOnly() const
+   {
+      return transformsReadOnly;
+   }
+
+   void setTransformsReadOnly(bool readOnly)
+   {
+      transformsReadOnly = readOnly;
+   }
+
    template<typename... ComponentTypes>
    Entity* createEntity()
    {
-      entities.push_back(Entity::create<ComponentTypes...>(*this));
-      return entities.back().get();
+      return addEntity(Entity::create<ComponentTypes...>(*this));
    }
 
    Entity* createEntity(gsl::span<std::string> componentClassNames)
    {
-      entities.push_back(Entity::create(componentClassNames, *this));
-      return entities.back().get();
+      return addEntity(Entity::create(componentClassNames, *this));
    }
 
+   // Creates many entities with the same set of components, reserving all scene storage up front
+   template<typename... ComponentTypes>
+   std::vector<Entity*> createEntities(std::size_t count);
+
+   // Creates entities in bulk from resolved component classes (see Entity::findComponentClass()). Entity i is given the
+   // next componentCounts[i] classes of componentClasses. All scene storage is reserved up front.
+   std::vector<Entity*> createEntities(gsl::span<const uint32_t> componentCounts, gsl::span<const ComponentClass* const> componentClasses);
+
+   // Destroys the entity immediately, unless the scene is ticking (in which case it is destroyed at the end of the tick)
    bool destroyEntity(Entity* entityToDestroy);
 
+   // Destroys all of the given entities in a single pass over the scene's entity list. Takes handles, so that duplicates
+   // and entities that were already destroyed are safely skipped.
+   void destroyEntities(gsl::span<const EntityHandle> entitiesToDestroy);
+
+   // Defers destruction until the end of the current (or next) tick
+   void queueEntityDestruction(Entity* entityToDestroy);
+
+   // Returns null if the entity has been destroyed
+   Entity* resolveEntityHandle(const EntityHandle& handle) const;
+
+   // Entities are removed by swapping with the last entity, so the order is not stable
    const std::vector<UPtr<Entity>>& getEntities() const
    {
       return entities;
@@ -82,6 +187,15 @@ public:
    void registerModelComponent(ModelComponent* modelComponent);
    void unregisterModelComponent(ModelComponent* modelComponent);
 
+   // Queues the model's bounding volume to be updated at the end of the tick
+   void markModelComponentDirty(ModelComponent* modelComponent);
+
+   // Contains the world bounds of all model components, as of the end of the last tick
+   const BoundingVolumeHierarchy<ModelComponent>& getModelBoundingVolumeHierarchy() const
+   {
+      return modelBoundingVolumeHierarchy;
+   }
+
    const std::vector<DirectionalLightComponent*>& getDirectionalLightComponents() const
    {
       return directionalLightComponents;
@@ -106,18 +220,161 @@ public:
    void registerSpotLightComponent(SpotLightComponent* spotLightComponent);
    void unregisterSpotLightComponent(SpotLightComponent* spotLightComponent);
 
+   // Influence bounds of all point lights, in the same order as getPointLightComponents() (as of the end of the last tick)
+   const LightSceneData& getPointLightData() const
+   {
+      return pointLightData;
+   }
+
+   // Bounds of the cone of all spot lights, in the same order as getSpotLightComponents() (as of the end of the last tick)
+   const LightSceneData& getSpotLightData() const
+   {
+      return spotLightData;
+   }
+
+   // Queues the light's scene data to be updated at the end of the tick
+   void markLightComponentDirty(LightComponent* lightComponent);
+
+   // Contains the influence bounds of all point and spot lights, as of the end of the last tick
+   const BoundingVolumeHierarchy<LightComponent>& getLightBoundingVolumeHierarchy() const
+   {
+      return lightBoundingVolumeHierarchy;
+   }
+
+   // Calls func(const LightComponent*) for each point and spot light that may reach the given bounds (conservatively, so
+   // a light can be reported even though it is slightly out of range)
+   template<typename Func>
+   void forEachLightAffecting(const Bounds& worldBounds, Func&& func) const;
+
 private:
+   static const std::size_t kNumTickGroups = static_cast<std::size_t>(TickGroup::Late) + 1;
+
+   struct EntitySlot
+   {
+      Entity* entity = nullptr;
+      uint32_t generation = 0;
+   };
+
+   // Components are referenced by their tick list index, since serial ticks can destroy components that are due later
+   struct TickGroupComponents
+   {
+      // Thread safe components, indexed by phase (hierarchy depth for components that access transforms, otherwise zero)
+      std::vector<std::vector<std::size_t>> parallelPhases;
+
+      // Ticked on the calling thread after all parallel phases, in tick list order
+      std::vector<std::size_t> serialComponents;
+   };
+
+   void tickSerial();
+   void tickParallel();
+   void finishComponentTick(std::size_t tickListIndex);
+   void compactTickingComponents();
+   std::unique_lock<std::mutex> lockIfTickingInParallel();
+
+   Entity* addEntity(UPtr<Entity> entity);
+   // Reserves storage for entityCount new entities, with the components in componentTypeMasks repeated maskRepeatCount times
+   void reserveEntities(std::size_t entityCount, gsl::span<const ComponentTypeMask> componentTypeMasks, std::size_t maskRepeatCount);
+   bool ownsEntity(const Entity* entity) const;
+   void flushEntityDestructionQueue();
+
+   template<typename T>
+   void registerComponent(std::vector<T*>& components, T* component);
+
+   // Returns the index the component was removed from (which now holds the component that used to be last)
+   template<typename T>
+   std::size_t unregisterComponent(std::vector<T*>& components, T* component);
+
+   template<typename T>
+   void removeDirtyComponent(std::vector<T*>& dirtyComponents, T* component);
+
+   void updateModelBoundingVolumes();
+   void updateLightData();
+
    float time;
    float deltaTime;
+   bool ticking;
+   bool parallelTickEnabled;
+   bool tickingInParallel;
+   std::mutex tickMutex;
+   std::array<TickGroupComponents, kNumTickGroups> tickGroupComponents;
+
+   // Components with tick functions, along with when they last ticked and when they are next due
+   std::vector<Component*> tickingComponents;
+   std::vector<float> lastTickTimes;
+   std::vector<float> nextTickTimes;
+   std::vector<std::size_t> dueTickIndices;
+   bool tickingComponentsRemoved;
+   TickSignificanceFunction tickSignificanceFunction;
+
+   std::vector<SceneComponent*> dirtyTransformComponents;
+   bool transformsReadOnly;
 
    std::vector<UPtr<Entity>> entities;
+   std::vector<EntitySlot> entitySlots;
+   std::vector<uint32_t> freeEntitySlots;
+   std::vector<EntityHandle> entityDestructionQueue;
 
    std::vector<CameraComponent*> cameraComponents;
    CameraComponent* activeCameraComponent;
 
    std::vector<ModelComponent*> modelComponents;
+   std::vector<ModelComponent*> dirtyModelComponents;
+   BoundingVolumeHierarchy<ModelComponent> modelBoundingVolumeHierarchy;
 
    std::vector<DirectionalLightComponent*> directionalLightComponents;
    std::vector<PointLightComponent*> pointLightComponents;
    std::vector<SpotLightComponent*> spotLightComponents;
+   std::vector<LightComponent*> dirtyLightComponents;
+   LightSceneData pointLightData;
+   LightSceneData spotLightData;
+   BoundingVolumeHierarchy<LightComponent> lightBoundingVolumeHierarchy;
 };
+
+namespace TickSignificance
+{
+   // Fully significant within fullDistance of the active camera, fading to insignificant at zeroDistance
+   Scene::TickSignificanceFunction cameraDistance(float fullDistance, float zeroDistance);
+}
+
+template<typename Func>
+void Scene::forEachLightAffecting(const Bounds& worldBounds, Func&& func) const
+{
+   glm::vec3 min = worldBounds.getMin();
+   glm::vec3 max = worldBounds.getMax();
+
+   auto boxOverlap = [&min, &max](const glm::vec3& nodeMin, const glm::vec3& nodeMax)
+   {
+      if (glm::any(glm::lessThan(nodeMax, min)) || glm::any(glm::greaterThan(nodeMin, max)))
+      {
+         return BoundsOverlap::Outside;
+      }
+
+      if (glm::all(glm::lessThanEqual(min, nodeMin)) && glm::all(glm::greaterThanEqual(max, nodeMax)))
+      {
+         return BoundsOverlap::Inside;
+      }
+
+      return BoundsOverlap::Intersecting;
+   };
+
+   lightBoundingVolumeHierarchy.query(boxOverlap, [&func](const LightComponent* lightComponent, bool fullyInside)
+   {
+      func(lightComponent);
+   });
+}
+
+template<typename... ComponentTypes>
+std::vector<Entity*> Scene::createEntities(std::size_t count)
+{
+   std::array<ComponentTypeMask, sizeof...(ComponentTypes)> componentTypeMasks = { ComponentTypeInfo<ComponentTypes>::getMask()... };
+   reserveEntities(count, componentTypeMasks, count);
+
+   std::vector<Entity*> newEntities;
+   newEntities.reserve(count);
+   for (std::size_t i = 0; i < count; ++i)
+   {
+      newEntities.push_back(createEntity<ComponentTypes...>());
+   }
+
+   return newEntities;
+}
@@ -0,0 +1,493 @@
+#include "Scene/SceneFile.h"
+
+#include "Core/Assert.h"
+#include "Core/Log.h"
+#include "Platform/IOUtils.h"
+#include "Platform/MappedFile.h"
+#include "Resources/ResourceManager.h"
+#include "Scene/Components/ModelComponent.h"
+#include "Scene/Components/SceneComponent.h"
+#include "Scene/Entity.h"
+#include "Scene/Scene.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+   // "SWSC", as a little endian integer
+   const uint32_t kMagic = 0x43535753;
+   const uint32_t kVersion = 1;
+   const uint32_t kNone = 0xFFFFFFFF;
+
+   // Every record is made of 4 byte fields, and every section starts on a 4 byte boundary, so that records can be read in
+   // place from the mapped file (the format is little endian, like all supported platforms). Offsets are in bytes, from
+   // the start of the file.
+   struct Header
+   {
+      uint32_t magic;
+      uint32_t version;
+
+      uint32_t numEntities;
+      uint32_t entitiesOffset;
+      uint32_t numComponents;
+      uint32_t componentsOffset;
+      uint32_t numTransforms;
+      uint32_t transformsOffset;
+      uint32_t numModels;
+      uint32_t modelsOffset;
+      uint32_t numStrings;
+      uint32_t stringsOffset;
+      uint32_t stringDataSize;
+      uint32_t stringDataOffset;
+   };
+
+   // The components of each entity directly follow those of the previous entity
+   struct EntityRecord
+   {
+      uint32_t numComponents;
+   };
+
+   struct ComponentRecord
+   {
+      uint32_t className; // String index
+      uint32_t transform; // Relative transform index, or kNone for components that aren't scene components
+      uint32_t parent; // Component index of the parent (always earlier in the same entity), or kNone
+      uint32_t mobility;
+   };
+
+   struct TransformRecord
+   {
+      float position[3];
+      float orientation[4]; // x, y, z, w
+      float scale[3];
+   };
+
+   struct ModelRecord
+   {
+      uint32_t component;
+      uint32_t path; // String index
+   };
+
+   struct StringRecord
+   {
+      uint32_t offset; // Into the string data
+      uint32_t length;
+   };
+
+   static_assert(sizeof(Header) == 14 * sizeof(uint32_t), "Scene file records must not contain padding");
+   static_assert(sizeof(ComponentRecord) == 4 * sizeof(uint32_t), "Scene file records must not contain padding");
+   static_assert(sizeof(TransformRecord) == 10 * sizeof(float), "Scene file records must not contain padding");
+
+   class StringTable
+   {
+   public:
+      uint32_t add(const std::string& value)
+      {
+         auto location = indices.find(value);
+         if (location != indices.end())
+         {
+            return location->second;
+         }
+
+         StringRecord record;
+         record.offset = static_cast<uint32_t>(data.size());
+         record.length = static_cast<uint32_t>(value.size());
+
+         uint32_t index = static_cast<uint32_t>(records.size());
+         records.push_back(record);
+         data.insert(data.end(), value.begin(), value.end());
+         indices.emplace(value, index);
+
+         return index;
+      }
+
+      const std::vector<StringRecord>& getRecords() const
+      {
+         return records;
+      }
+
+      const std::vector<char>& getData() const
+      {
+         return data;
+      }
+
+   private:
+      std::vector<StringRecord> records;
+      std::vector<char> data;
+      std::unordered_map<std::string, uint32_t> indices;
+   };
+
+   template<typename T>
+   uint32_t appendSection(std::vector<uint8_t>& fileData, const std::vector<T>& records)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "Scene file records are written as raw memory");
+
+      fileData.resize((fileData.size() + 3) & ~std::size_t(3), 0);
+      uint32_t offset = static_cast<uint32_t>(fileData.size());
+
+      fileData.resize(fileData.size() + records.size() * sizeof(T));
+      if (!records.empty())
+      {
+         std::memcpy(fileData.data() + offset, records.data(), records.size() * sizeof(T));
+      }
+
+      return offset;
+   }
+
+   // Returns null if the section doesn't fit within the file
+   template<typename T>
+   const T* getSection(const MappedFile& file, uint32_t offset, uint32_t count)
+   {
+      if (offset % alignof(T) != 0 || offset > file.getSize() || count > (file.getSize() - offset) / sizeof(T))
+      {
+         return nullptr;
+      }
+
+      return reinterpret_cast<const T*>(file.getData() + offset);
+   }
+
+   std::size_t getHierarchyDepth(const Component* component)
+   {
+      std::size_t depth = 0;
+      if (component->isA<SceneComponent>())
+      {
+         for (const SceneComponent* parent = static_cast<const SceneComponent*>(component)->getParent(); parent; parent = parent->getParent())
+         {
+            ++depth;
+         }
+      }
+
+      return depth;
+   }
+
+   TransformRecord packTransform(const Transform& transform)
+   {
+      TransformRecord record;
+      std::memcpy(record.position, &transform.position, sizeof(record.position));
+      record.orientation[0] = transform.orientation.x;
+      record.orientation[1] = transform.orientation.y;
+      record.orientation[2] = transform.orientation.z;
+      record.orientation[3] = transform.orientation.w;
+      std::memcpy(record.scale, &transform.scale, sizeof(record.scale));
+
+      return record;
+   }
+
+   Transform unpackTransform(const TransformRecord& record)
+   {
+      Transform transform;
+      transform.position = glm::vec3(record.position[0], record.position[1], record.position[2]);
+      transform.orientation = glm::quat(record.orientation[3], record.orientation[0], record.orientation[1], record.orientation[2]);
+      transform.scale = glm::vec3(record.scale[0], record.scale[1], record.scale[2]);
+
+      return transform;
+   }
+}
+
+namespace SceneFile
+{
+   bool save(const Scene& scene, const std::string& path, const ModelPathFunc& getModelPath)
+   {
+      StringTable strings;
+      std::vector<EntityRecord> entityRecords;
+      std::vector<ComponentRecord> componentRecords;
+      std::vector<TransformRecord> transformRecords;
+      std::vector<ModelRecord> modelRecords;
+
+      std::vector<const Component*> entityComponents;
+      entityRecords.reserve(scene.getEntities().size());
+      for (const UPtr<Entity>& entity : scene.getEntities())
+      {
+         if (entity->isPendingDestruction())
+         {
+            continue;
+         }
+
+         // Components of unregistered classes couldn't be created again when loading
+         entityComponents.clear();
+         for (const Component* component : static_cast<const Entity&>(*entity).getComponentsByClass<Component>())
+         {
+            if (Entity::findComponentClassName(*component))
+            {
+               entityComponents.push_back(component);
+            }
+         }
+
+         // Parents need to be created before their children
+         std::stable_sort(entityComponents.begin(), entityComponents.end(), [](const Component* first, const Component* second)
+         {
+            return getHierarchyDepth(first) < getHierarchyDepth(second);
+         });
+
+         uint32_t firstComponent = static_cast<uint32_t>(componentRecords.size());
+         for (const Component* component : entityComponents)
+         {
+            ComponentRecord componentRecord;
+            componentRecord.className = strings.add(*Entity::findComponentClassName(*component));
+            componentRecord.transform = kNone;
+            componentRecord.parent = kNone;
+            componentRecord.mobility = static_cast<uint32_t>(Mobility::Movable);
+
+            if (component->isA<SceneComponent>())
+            {
+               const SceneComponent* sceneComponent = static_cast<const SceneComponent*>(component);
+
+               componentRecord.transform = static_cast<uint32_t>(transformRecords.size());
+               transformRecords.push_back(packTransform(sceneComponent->getRelativeTransform()));
+
+               componentRecord.mobility = static_cast<uint32_t>(sceneComponent->getMobility());
+
+               auto parentLocation = std::find(entityComponents.begin(), entityComponents.end(), sceneComponent->getParent());
+               if (parentLocation != entityComponents.end())
+               {
+                  componentRecord.parent = firstComponent + static_cast<uint32_t>(parentLocation - entityComponents.begin());
+               }
+            }
+
+            if (component->isA<ModelComponent>())
+            {
+               std::string modelPath = getModelPath ? getModelPath(*static_cast<const ModelComponent*>(component)) : std::string();
+               if (!modelPath.empty())
+               {
+                  ModelRecord modelRecord;
+                  modelRecord.component = static_cast<uint32_t>(componentRecords.size());
+                  modelRecord.path = strings.add(modelPath);
+                  modelRecords.push_back(modelRecord);
+               }
+            }
+
+            componentRecords.push_back(componentRecord);
+         }
+
+         EntityRecord entityRecord;
+         entityRecord.numComponents = static_cast<uint32_t>(entityComponents.size());
+         entityRecords.push_back(entityRecord);
+      }
+
+      std::vector<uint8_t> fileData(sizeof(Header));
+
+      Header header;
+      header.magic = kMagic;
+      header.version = kVersion;
+      header.numEntities = static_cast<uint32_t>(entityRecords.size());
+      header.entitiesOffset = appendSection(fileData, entityRecords);
+      header.numComponents = static_cast<uint32_t>(componentRecords.size());
+      header.componentsOffset = appendSection(fileData, componentRecords);
+      header.numTransforms = static_cast<uint32_t>(transformRecords.size());
+      header.transformsOffset = appendSection(fileData, transformRecords);
+      header.numModels = static_cast<uint32_t>(modelRecords.size());
+      header.modelsOffset = appendSection(fileData, modelRecords);
+      header.numStrings = static_cast<uint32_t>(strings.getRecords().size());
+      header.stringsOffset = appendSection(fileData, strings.getRecords());
+      header.stringDataSize = static_cast<uint32_t>(strings.getData().size());
+      header.stringDataOffset = appendSection(fileData, strings.getData());
+      std::memcpy(fileData.data(), &header, sizeof(header));
+
+      return IOUtils::writeBinaryFile(path, fileData);
+   }
+
+   bool load(const std::string& path, Scene& scene, ResourceManager& resourceManager)
+   {
+      MappedFile file;
+      if (!file.open(path))
+      {
+         LOG_WARNING("Unable to open scene file: " << path);
+         return false;
+      }
+
+      Header header;
+      if (file.getSize() < sizeof(header))
+      {
+         LOG_WARNING("Invalid scene file: " << path);
+         return false;
+      }
+      std::memcpy(&header, file.getData(), sizeof(header));
+
+      if (header.magic != kMagic || header.version != kVersion)
+      {
+         LOG_WARNING("Unsupported scene file: " << path);
+         return false;
+      }
+
+      const EntityRecord* entityRecords = getSection<EntityRecord>(file, header.entitiesOffset, header.numEntities);
+      const ComponentRecord* componentRecords = getSection<ComponentRecord>(file, header.componentsOffset, header.numComponents);
+      const TransformRecord* transformRecords = getSection<TransformRecord>(file, header.transformsOffset, header.numTransforms);
+      const ModelRecord* modelRecords = getSection<ModelRecord>(file, header.modelsOffset, header.numModels);
+      const StringRecord* stringRecords = getSection<StringRecord>(file, header.stringsOffset, header.numStrings);
+      const char* stringData = getSection<char>(file, header.stringDataOffset, header.stringDataSize);
+      if (!entityRecords || !componentRecords || !transformRecords || !modelRecords || !stringRecords || !stringData)
+      {
+         LOG_WARNING("Truncated scene file: " << path);
+         return false;
+      }
+
+      auto isValidString = [&header, stringRecords](uint32_t index)
+      {
+         return index < header.numStrings && stringRecords[index].offset <= header.stringDataSize && stringRecords[index].length <= header.stringDataSize - stringRecords[index].offset;
+      };
+      auto getString = [stringRecords, stringData](uint32_t index)
+      {
+         return std::string(stringData + stringRecords[index].offset, stringRecords[index].length);
+      };
+
+      // Validate everything before creating anything, so that a bad file leaves the scene untouched. Class names are only
+      // looked up once each, no matter how many components use them.
+      std::vector<const ComponentClass*> componentClassesByString(header.numStrings, nullptr);
+      std::vector<uint8_t> resolvedStrings(header.numStrings, 0);
+
+      std::vector<uint32_t> componentCounts(header.numEntities, 0);
+      std::vector<const ComponentClass*> componentClasses;
+      componentClasses.reserve(header.numComponents);
+
+      // Maps each component in the file to its index in componentClasses (or kNone if its class isn't registered)
+      std::vector<uint32_t> createdComponentIndices(header.numComponents, kNone);
+
+      uint32_t componentIndex = 0;
+      for (uint32_t entityIndex = 0; entityIndex < header.numEntities; ++entityIndex)
+      {
+         uint32_t numComponents = entityRecords[entityIndex].numComponents;
+         if (numComponents > header.numComponents - componentIndex)
+         {
+            LOG_WARNING("Invalid entity in scene file: " << path);
+            return false;
+         }
+
+         uint32_t firstComponent = componentIndex;
+         for (; componentIndex < firstComponent + numComponents; ++componentIndex)
+         {
+            const ComponentRecord& componentRecord = componentRecords[componentIndex];
+
+            bool validParent = componentRecord.parent == kNone || (componentRecord.parent >= firstComponent && componentRecord.parent < componentIndex);
+            bool validTransform = componentRecord.transform == kNone || componentRecord.transform < header.numTransforms;
+            bool validMobility = componentRecord.mobility <= static_cast<uint32_t>(Mobility::Movable);
+            if (!isValidString(componentRecord.className) || !validParent || !validTransform || !validMobility)
+            {
+               LOG_WARNING("Invalid component in scene file: " << path);
+               return false;
+            }
+
+            if (!resolvedStrings[componentRecord.className])
+            {
+               std::string className = getString(componentRecord.className);
+               componentClassesByString[componentRecord.className] = Entity::findComponentClass(className);
+               resolvedStrings[componentRecord.className] = 1;
+
+               if (!componentClassesByString[componentRecord.className])
+               {
+                  LOG_WARNING("Skipping components of unregistered class " << className << " in scene file: " << path);
+               }
+            }
+
+            if (const ComponentClass* componentClass = componentClassesByString[componentRecord.className])
+            {
+               createdComponentIndices[componentIndex] = static_cast<uint32_t>(componentClasses.size());
+               componentClasses.push_back(componentClass);
+               ++componentCounts[entityIndex];
+            }
+         }
+      }
+
+      if (componentIndex != header.numComponents)
+      {
+         LOG_WARNING("Components without an entity in scene file: " << path);
+         return false;
+      }
+
+      for (uint32_t modelIndex = 0; modelIndex < header.numModels; ++modelIndex)
+      {
+         if (modelRecords[modelIndex].component >= header.numComponents || !isValidString(modelRecords[modelIndex].path))
+         {
+            LOG_WARNING("Invalid model in scene file: " << path);
+            return false;
+         }
+      }
+
+      std::vector<Entity*> entities = scene.createEntities(componentCounts, componentClasses);
+
+      // Components are created in order, but initialization may add more, so only take as many as were requested
+      std::vector<Component*> createdComponents;
+      createdComponents.reserve(componentClasses.size());
+      for (std::size_t entityIndex = 0; entityIndex < entities.size(); ++entityIndex)
+      {
+         uint32_t numCreated = 0;
+         for (Component* component : entities[entityIndex]->getComponentsByClass<Component>())
+         {
+            if (numCreated++ == componentCounts[entityIndex])
+            {
+               break;
+            }
+
+            createdComponents.push_back(component);
+         }
+      }
+      ASSERT(createdComponents.size() == componentClasses.size());
+
+      auto getCreatedComponent = [&createdComponents, &createdComponentIndices](uint32_t index) -> Component*
+      {
+         return createdComponentIndices[index] != kNone ? createdComponents[createdComponentIndices[index]] : nullptr;
+      };
+
+      for (uint32_t index = 0; index < header.numComponents; ++index)
+      {
+         Component* component = getCreatedComponent(index);
+         if (!component || !component->isA<SceneComponent>())
+         {
+            continue;
+         }
+
+         const ComponentRecord& componentRecord = componentRecords[index];
+         SceneComponent* sceneComponent = static_cast<SceneComponent*>(component);
+
+         if (componentRecord.parent != kNone)
+         {
+            Component* parent = getCreatedComponent(componentRecord.parent);
+            if (parent && parent->isA<SceneComponent>())
+            {
+               sceneComponent->setParent(static_cast<SceneComponent*>(parent));
+            }
+         }
+
+         if (componentRecord.transform != kNone)
+         {
+            sceneComponent->setRelativeTransform(unpackTransform(transformRecords[componentRecord.transform]));
+         }
+
+         sceneComponent->setMobility(static_cast<Mobility>(componentRecord.mobility));
+      }
+
+      // Each model is only loaded once, no matter how many components use it
+      std::unordered_map<uint32_t, Model> loadedModels;
+      for (uint32_t modelIndex = 0; modelIndex < header.numModels; ++modelIndex)
+      {
+         const ModelRecord& modelRecord = modelRecords[modelIndex];
+
+         Component* component = getCreatedComponent(modelRecord.component);
+         if (!component || !component->isA<ModelComponent>())
+         {
+            continue;
+         }
+
+         auto location = loadedModels.find(modelRecord.path);
+         if (location == loadedModels.end())
+         {
+            ModelSpecification modelSpecification;
+            if (!IOUtils::getAbsoluteResourcePath(getString(modelRecord.path), modelSpecification.path))
+            {
+               LOG_WARNING("Unable to resolve model path " << getString(modelRecord.path) << " in scene file: " << path);
+               continue;
+            }
+
+            location = loadedModels.emplace(modelRecord.path, resourceManager.loadModel(modelSpecification)).first;
+         }
+
+         static_cast<ModelComponent*>(component)->setModel(location->second);
+      }
+
+      return true;
+   }
+}
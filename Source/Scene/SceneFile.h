@@ -0,0 +1,23 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+class ModelComponent;
+class ResourceManager;
+class Scene;
+
+// Compact binary scene format, designed to be loaded straight out of a memory mapped file. Component class names and
+// model paths are stored once in a string table, transforms are packed into a single array, and parents are stored as
+// component indices. Entities are created in bulk, so large scenes load at close to the speed of the file I/O.
+namespace SceneFile
+{
+   // Returns the path (relative to the resource directory) that the component's model was loaded from, or an empty
+   // string if the model shouldn't be saved
+   using ModelPathFunc = std::function<std::string(const ModelComponent&)>;
+
+   bool save(const Scene& scene, const std::string& path, const ModelPathFunc& getModelPath);
+
+   // Adds the entities in the file to the scene. Components of unregistered classes are skipped.
+   bool load(const std::string& path, Scene& scene, ResourceManager& resourceManager);
+}